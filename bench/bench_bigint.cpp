@@ -0,0 +1,557 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bigint.h"
+#include "bigint_accumulator.h"
+#include "bigint_limbs.h"
+#include "bigint_tree.h"
+#include "fixed_bigint.h"
+#include "thread_pool.h"
+
+using namespace std::literals::string_literals;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using namespace bigint_huawei;
+
+/**
+ * Runs the function until at least 20 ms elapsed and returns the average
+ * time of one run in microseconds.
+ */
+double MeasureMicroseconds(const std::function<void()> &run) {
+  using clock = std::chrono::steady_clock;
+  run(); // warmup
+  size_t runs = 0;
+  auto start = clock::now();
+  std::chrono::duration<double, std::micro> elapsed(0);
+  do {
+    run();
+    ++runs;
+    elapsed = clock::now() - start;
+  } while (elapsed.count() < 20000);
+  return elapsed.count() / runs;
+}
+
+vector<uint32_t> RandomLimbs(size_t n, std::mt19937 &generator) {
+  std::uniform_int_distribution<uint32_t> distribution(0, BigInt::BASE - 1);
+  vector<uint32_t> result(n);
+  for (uint32_t &limb : result) {
+    limb = distribution(generator);
+  }
+  result.back() = std::max<uint32_t>(result.back(), 1);
+  return result;
+}
+
+/**
+ * Times one level of every multiplication algorithm for balanced operands,
+ * the subproducts use the current thresholds. The fastest algorithm for
+ * every size shows where the thresholds should be.
+ */
+void BenchMultiplicationCrossover() {
+  cout << "Multiplication crossover (balanced operands, us per product)"s
+       << endl;
+  cout << std::setw(8) << "limbs"s << std::setw(14) << "schoolbook"s
+       << std::setw(14) << "karatsuba"s << std::setw(14) << "toom3"s
+       << std::setw(12) << "best"s << endl;
+
+  std::mt19937 generator(42);
+  for (size_t n : {8, 16, 24, 32, 40, 48, 64, 96, 128, 160, 192, 256, 384, 512,
+                   768, 1024, 2048}) {
+    vector<uint32_t> a = RandomLimbs(n, generator);
+    vector<uint32_t> b = RandomLimbs(n, generator);
+    vector<uint32_t> result(2 * n);
+    limbs::Scratch scratch(8 * n);
+
+    double schoolbook = MeasureMicroseconds([&]() {
+      limbs::mul_basecase(a.data(), n, b.data(), n, result.data());
+    });
+    double karatsuba = MeasureMicroseconds([&]() {
+      limbs::mul_karatsuba(a.data(), n, b.data(), n, result.data(), scratch);
+    });
+    double toom3 = MeasureMicroseconds([&]() {
+      limbs::mul_toom3(a.data(), n, b.data(), n, result.data(), scratch);
+    });
+
+    string best = "schoolbook"s;
+    if (karatsuba < schoolbook && karatsuba <= toom3) {
+      best = "karatsuba"s;
+    } else if (toom3 < schoolbook && toom3 < karatsuba) {
+      best = "toom3"s;
+    }
+    cout << std::fixed << std::setprecision(2) << std::setw(8) << n
+         << std::setw(14) << schoolbook << std::setw(14) << karatsuba
+         << std::setw(14) << toom3 << std::setw(12) << best << endl;
+  }
+  cout << "Thresholds in use: Karatsuba from "s << limbs::KARATSUBA_THRESHOLD
+       << " limbs, Toom-3 from "s << limbs::TOOM3_THRESHOLD << " limbs"s
+       << endl;
+}
+
+/**
+ * Times one level of Toom-3 against NTT multiplication for large balanced
+ * operands.
+ */
+void BenchNttCrossover() {
+  cout << "NTT crossover (balanced operands, ms per product)"s << endl;
+  cout << std::setw(8) << "limbs"s << std::setw(14) << "toom3"s
+       << std::setw(14) << "ntt"s << std::setw(12) << "best"s << endl;
+
+  std::mt19937 generator(42);
+  for (size_t n : {1024, 2048, 4096, 8192, 16384, 65536}) {
+    vector<uint32_t> a = RandomLimbs(n, generator);
+    vector<uint32_t> b = RandomLimbs(n, generator);
+    vector<uint32_t> result(2 * n);
+    limbs::Scratch scratch(16 * n);
+
+    double toom3 = MeasureMicroseconds([&]() {
+      limbs::mul_toom3(a.data(), n, b.data(), n, result.data(), scratch);
+    });
+    double ntt = MeasureMicroseconds([&]() {
+      limbs::mul_ntt(a.data(), n, b.data(), n, result.data(), scratch);
+    });
+    cout << std::fixed << std::setprecision(3) << std::setw(8) << n
+         << std::setw(14) << toom3 / 1000 << std::setw(14) << ntt / 1000
+         << std::setw(12) << (ntt < toom3 ? "ntt"s : "toom3"s) << endl;
+  }
+  cout << "Threshold in use: NTT from "s << limbs::NTT_THRESHOLD << " limbs"s
+       << endl;
+}
+
+/**
+ * Times schoolbook against Newton division of 2n limbs by n limbs.
+ */
+void BenchDivisionCrossover() {
+  cout << "Division crossover (2n by n limbs, us per division)"s << endl;
+  cout << std::setw(8) << "limbs"s << std::setw(14) << "schoolbook"s
+       << std::setw(14) << "newton"s << std::setw(12) << "best"s << endl;
+
+  std::mt19937 generator(42);
+  for (size_t n : {64, 128, 256, 512, 768, 1024, 2048, 4096, 16384}) {
+    vector<uint32_t> a = RandomLimbs(2 * n, generator);
+    vector<uint32_t> b = RandomLimbs(n, generator);
+    vector<uint32_t> quotient(n + 1), remainder(n);
+    limbs::Scratch scratch(32 * n);
+
+    double schoolbook = MeasureMicroseconds([&]() {
+      limbs::divmod_knuth(a.data(), 2 * n, b.data(), n, quotient.data(),
+                          remainder.data(), scratch);
+    });
+    double newton = MeasureMicroseconds([&]() {
+      limbs::divmod_newton(a.data(), 2 * n, b.data(), n, quotient.data(),
+                           remainder.data(), scratch);
+    });
+    cout << std::fixed << std::setprecision(2) << std::setw(8) << n
+         << std::setw(14) << schoolbook << std::setw(14) << newton
+         << std::setw(12) << (newton < schoolbook ? "newton"s : "schoolbook"s)
+         << endl;
+  }
+  cout << "Threshold in use: Newton from "s << limbs::DIV_NEWTON_THRESHOLD
+       << " limbs"s << endl;
+}
+
+/**
+ * Times modular exponentiation with Montgomery reduction (odd modulus),
+ * Barrett reduction (even modulus) and plain square and multiply with the
+ * remainder operator on every step.
+ */
+void BenchPowmod() {
+  cout << "Modular exponentiation (all operands of the same size, ms)"s << endl;
+  cout << std::setw(8) << "bits"s << std::setw(14) << "montgomery"s
+       << std::setw(14) << "barrett"s << std::setw(14) << "remainder"s << endl;
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  auto random_digits = [&](size_t len) {
+    string digits(len, '0');
+    for (char &digit : digits) {
+      digit = '0' + distribution_digit(generator);
+    }
+    digits[0] = '1';
+    return digits;
+  };
+  for (size_t bits : {512, 2048, 4096, 8192}) {
+    size_t digits = bits * 30103 / 100000;
+    string modulus = random_digits(digits);
+    modulus.back() = '7';
+    BigInt odd(modulus);
+    modulus.back() = '8';
+    BigInt even(modulus);
+    BigInt base(random_digits(digits - 1));
+    BigInt exponent(random_digits(digits));
+
+    double montgomery =
+        MeasureMicroseconds([&]() { powmod(base, exponent, odd); });
+    double barrett =
+        MeasureMicroseconds([&]() { powmod(base, exponent, even); });
+    double remainder = MeasureMicroseconds([&]() {
+      BigInt result(1);
+      for (char digit : exponent.to_string()) {
+        BigInt power = result;
+        for (int i = 1; i < 10; ++i) {
+          result = result * power % odd;
+        }
+        for (int i = 0; i < digit - '0'; ++i) {
+          result = result * base % odd;
+        }
+      }
+    });
+    cout << std::fixed << std::setprecision(2) << std::setw(8) << bits
+         << std::setw(14) << montgomery / 1000 << std::setw(14)
+         << barrett / 1000 << std::setw(14) << remainder / 1000 << endl;
+  }
+}
+
+/**
+ * Times summing of many numbers by a running BigInt sum and by
+ * BigIntAccumulator.
+ */
+void BenchSum() {
+  cout << "Sum of 1000000 numbers (ms)"s << endl;
+  cout << std::setw(8) << "digits"s << std::setw(14) << "operator+="s
+       << std::setw(14) << "accumulator"s << endl;
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  for (size_t digits : {18, 50, 200}) {
+    vector<BigInt> numbers;
+    for (int i = 0; i < 1000000; ++i) {
+      string number(digits, '0');
+      for (char &digit : number) {
+        digit = '0' + distribution_digit(generator);
+      }
+      numbers.emplace_back(number);
+    }
+
+    double running = MeasureMicroseconds([&]() {
+      BigInt sum;
+      for (const BigInt &number : numbers) {
+        sum += number;
+      }
+    });
+    double accumulated = MeasureMicroseconds([&]() {
+      BigIntAccumulator accumulator;
+      for (const BigInt &number : numbers) {
+        accumulator += number;
+      }
+      accumulator.finish();
+    });
+    cout << std::fixed << std::setprecision(2) << std::setw(8) << digits
+         << std::setw(14) << running / 1000 << std::setw(14)
+         << accumulated / 1000 << endl;
+  }
+}
+
+/**
+ * Times serial and parallel addition of long arrays on the shared pool.
+ */
+void BenchParallelAddition() {
+  thread_pool_huawei::ThreadPool &pool =
+      thread_pool_huawei::ThreadPool::shared();
+  cout << "Parallel addition ("s << pool.size() << " threads, ms)"s << endl;
+  cout << std::setw(10) << "limbs"s << std::setw(14) << "serial"s
+       << std::setw(14) << "parallel"s << endl;
+
+  std::mt19937 generator(42);
+  for (size_t n : {size_t(1) << 18, size_t(1) << 20, size_t(1) << 22,
+                   size_t(1) << 24}) {
+    vector<uint32_t> a = RandomLimbs(n, generator);
+    vector<uint32_t> b = RandomLimbs(n, generator);
+    vector<uint32_t> result(n);
+
+    double serial = MeasureMicroseconds(
+        [&]() { limbs::add_n(a.data(), b.data(), result.data(), n); });
+    double parallel = MeasureMicroseconds([&]() {
+      limbs::add_n_parallel(a.data(), b.data(), result.data(), n, 0, pool);
+    });
+    cout << std::fixed << std::setprecision(3) << std::setw(10) << n
+         << std::setw(14) << serial / 1000 << std::setw(14) << parallel / 1000
+         << endl;
+  }
+  cout << "Threshold in use: parallel from "s << limbs::PARALLEL_ADD_THRESHOLD
+       << " limbs"s << endl;
+}
+
+/**
+ * Times gcd against Euclid's algorithm by repeated remainders.
+ */
+void BenchGcd() {
+  cout << "GCD of numbers of the same size (ms)"s << endl;
+  cout << std::setw(8) << "digits"s << std::setw(14) << "euclid"s
+       << std::setw(14) << "gcd"s << endl;
+
+  std::mt19937 generator(42);
+  for (size_t digits : {300, 1000, 3000, 10000, 30000}) {
+    size_t n = digits / BigInt::BASE_DIGITS;
+    vector<uint32_t> a_limbs = RandomLimbs(n, generator);
+    vector<uint32_t> b_limbs = RandomLimbs(n, generator);
+    std::string a_digits, b_digits;
+    for (size_t i = n; i > 0; --i) {
+      a_digits += std::to_string(a_limbs[i - 1] + BigInt::BASE).substr(1);
+      b_digits += std::to_string(b_limbs[i - 1] + BigInt::BASE).substr(1);
+    }
+    BigInt a(a_digits), b(b_digits);
+
+    double euclid = MeasureMicroseconds([&]() {
+      BigInt x = a, y = b;
+      while (y != BigInt()) {
+        x %= y;
+        std::swap(x, y);
+      }
+    });
+    double fast = MeasureMicroseconds([&]() { gcd(a, b); });
+    cout << std::fixed << std::setprecision(2) << std::setw(8) << digits
+         << std::setw(14) << euclid / 1000 << std::setw(14) << fast / 1000
+         << endl;
+  }
+}
+
+/**
+ * Times 256-bit operations on FixedBigInt against BigInt of the same values.
+ */
+void BenchFixedWidth() {
+  cout << "256-bit numbers (ns per operation)"s << endl;
+  cout << std::setw(8) << "op"s << std::setw(14) << "BigInt"s
+       << std::setw(14) << "FixedBigInt"s << endl;
+
+  constexpr int COUNT = 1000;
+  std::mt19937 generator(42);
+  vector<BigInt> numbers;
+  vector<FixedBigInt<256>> fixed_numbers;
+  BigInt modulus = pow(BigInt(2), 256);
+  for (int i = 0; i < COUNT; ++i) {
+    vector<uint8_t> bytes(31);
+    for (uint8_t &byte : bytes) {
+      byte = generator();
+    }
+    numbers.push_back(BigInt::from_bytes(bytes.data(), bytes.size()));
+    fixed_numbers.emplace_back(numbers.back());
+  }
+
+  double big_add = MeasureMicroseconds([&]() {
+    BigInt sum;
+    for (const BigInt &number : numbers) {
+      sum += number;
+    }
+  });
+  double fixed_add = MeasureMicroseconds([&]() {
+    FixedBigInt<256> sum;
+    for (const FixedBigInt<256> &number : fixed_numbers) {
+      sum += number;
+    }
+    asm volatile("" : : "r"(&sum) : "memory");
+  });
+  double big_mul = MeasureMicroseconds([&]() {
+    for (int i = 1; i < COUNT; ++i) {
+      BigInt product = numbers[i - 1] * numbers[i];
+    }
+  });
+  double fixed_mul = MeasureMicroseconds([&]() {
+    FixedBigInt<256> product = 1;
+    for (const FixedBigInt<256> &number : fixed_numbers) {
+      product *= number;
+    }
+    asm volatile("" : : "r"(&product) : "memory");
+  });
+  cout << std::fixed << std::setprecision(1) << std::setw(8) << "add"s
+       << std::setw(14) << big_add * 1000 / COUNT << std::setw(14)
+       << fixed_add * 1000 / COUNT << endl;
+  cout << std::setw(8) << "mul"s << std::setw(14) << big_mul * 1000 / COUNT
+       << std::setw(14) << fixed_mul * 1000 / COUNT << endl;
+}
+
+/**
+ * Times 100000! computed by the left to right fold and by the product tree
+ * on a single thread and on the shared pool. The fold is quadratic, so it
+ * runs only once.
+ */
+void BenchFactorial() {
+  using clock = std::chrono::steady_clock;
+  constexpr int N = 100000;
+  thread_pool_huawei::ThreadPool &pool =
+      thread_pool_huawei::ThreadPool::shared();
+  thread_pool_huawei::ThreadPool single(0);
+  cout << N << "! (ms)"s << endl;
+  cout << std::setw(14) << "fold"s << std::setw(14) << "tree"s
+       << std::setw(14) << "tree x"s << pool.size() + 1 << endl;
+
+  vector<BigInt> numbers;
+  for (int i = 1; i <= N; ++i) {
+    numbers.emplace_back(i);
+  }
+  auto start = clock::now();
+  BigInt fold(1);
+  for (const BigInt &number : numbers) {
+    fold *= number;
+  }
+  std::chrono::duration<double, std::milli> folded = clock::now() - start;
+  double tree = MeasureMicroseconds([&]() { product_tree(numbers, single); });
+  double parallel = MeasureMicroseconds([&]() { product_tree(numbers, pool); });
+  cout << std::fixed << std::setprecision(1) << std::setw(14)
+       << folded.count() << std::setw(14) << tree / 1000 << std::setw(15)
+       << parallel / 1000 << endl;
+}
+
+/**
+ * Timing statistics of one operation, times are of a single run.
+ */
+struct Timing {
+  size_t repetitions;
+  double median_ns;
+  double p99_ns;
+};
+
+/**
+ * Runs the operation a few times to warm up caches and the allocator, then
+ * collects samples until at least 5 samples and 200 ms (at most 1000
+ * samples). Fast operations are run in batches, so one sample is long
+ * enough for the clock.
+ */
+Timing MeasureSamples(const std::function<void()> &run) {
+  using clock = std::chrono::steady_clock;
+  using nanoseconds = std::chrono::duration<double, std::nano>;
+
+  size_t batch = 1;
+  while (true) {
+    auto start = clock::now();
+    for (size_t i = 0; i < batch; ++i) {
+      run();
+    }
+    if (nanoseconds(clock::now() - start).count() >= 2000 || batch >= 4096) {
+      break;
+    }
+    batch *= 2;
+  }
+
+  vector<double> samples;
+  nanoseconds total(0);
+  while (samples.size() < 1000 && (samples.size() < 5 || total.count() < 2e8)) {
+    auto start = clock::now();
+    for (size_t i = 0; i < batch; ++i) {
+      run();
+    }
+    nanoseconds elapsed = clock::now() - start;
+    total += elapsed;
+    samples.push_back(elapsed.count() / batch);
+  }
+  std::sort(samples.begin(), samples.end());
+  size_t p99 = std::min(samples.size() - 1, samples.size() * 99 / 100);
+  return {samples.size() * batch, samples[samples.size() / 2], samples[p99]};
+}
+
+string RandomDigits(size_t n, std::mt19937 &generator) {
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  string result(n, '0');
+  for (char &digit : result) {
+    digit = '0' + distribution_digit(generator);
+  }
+  result[0] = '1' + distribution_digit(generator) % 9;
+  return result;
+}
+
+/**
+ * Times parsing, formatting, addition, in-place addition and
+ * multiplication of numbers from 10 to max_digits digits (powers of 10),
+ * prints a table and, if json is not null, writes the results as JSON.
+ */
+void BenchScaling(size_t max_digits, std::ostream *json) {
+  cout << "Scaling (ns per operation, single run)"s << endl;
+  cout << std::setw(14) << "operation"s << std::setw(10) << "digits"s
+       << std::setw(16) << "median"s << std::setw(16) << "p99"s
+       << std::setw(12) << "ns/limb"s << endl;
+  if (json) {
+    *json << "{\n  \"benchmarks\": ["s;
+  }
+
+  std::mt19937 generator(42);
+  bool first = true;
+  for (size_t digits = 10; digits <= max_digits; digits *= 10) {
+    string a_digits = RandomDigits(digits, generator);
+    string b_digits = RandomDigits(digits, generator);
+    BigInt a(a_digits), b(b_digits), sum = a;
+    size_t limbs = (digits + BigInt::BASE_DIGITS - 1) / BigInt::BASE_DIGITS;
+
+    std::pair<string, std::function<void()>> operations[] = {
+        {"parse"s, [&]() { BigInt number(a_digits); }},
+        {"to_string"s, [&]() { a.to_string(); }},
+        {"add"s, [&]() { BigInt number = a + b; }},
+        {"add_in_place"s, [&]() { sum += b; }},
+        {"mul"s, [&]() { BigInt number = a * b; }},
+    };
+    for (const auto &[name, run] : operations) {
+      Timing timing = MeasureSamples(run);
+      double per_limb = timing.median_ns / limbs;
+      cout << std::fixed << std::setprecision(1) << std::setw(14) << name
+           << std::setw(10) << digits << std::setw(16) << timing.median_ns
+           << std::setw(16) << timing.p99_ns << std::setprecision(3)
+           << std::setw(12) << per_limb << endl;
+      if (json) {
+        *json << (first ? "\n"s : ",\n"s) << "    {\"operation\": \""s << name
+              << "\", \"digits\": "s << digits << ", \"limbs\": "s << limbs
+              << ", \"repetitions\": "s << timing.repetitions
+              << ", \"median_ns\": "s << timing.median_ns
+              << ", \"p99_ns\": "s << timing.p99_ns
+              << ", \"ns_per_limb\": "s << per_limb << "}"s;
+        first = false;
+      }
+    }
+  }
+  if (json) {
+    *json << "\n  ]\n}\n"s;
+  }
+}
+
+/**
+ * Runs all benchmarks. Options:
+ *  --scaling         run only the scaling suite
+ *  --max-digits N    largest size of the scaling suite (10^7 by default)
+ *  --json PATH       write results of the scaling suite to PATH as JSON
+ */
+int main(int argc, char *argv[]) {
+  bool scaling_only = false;
+  size_t max_digits = 10000000;
+  string json_path;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--scaling") == 0) {
+      scaling_only = true;
+    } else if (std::strcmp(argv[i], "--max-digits") == 0 && i + 1 < argc) {
+      max_digits = std::stoull(argv[++i]);
+    } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json_path = argv[++i];
+    } else {
+      std::cerr << "Usage: "s << argv[0]
+                << " [--scaling] [--max-digits N] [--json PATH]"s << endl;
+      return 1;
+    }
+  }
+
+  if (!scaling_only) {
+    BenchMultiplicationCrossover();
+    BenchNttCrossover();
+    BenchDivisionCrossover();
+    BenchPowmod();
+    BenchGcd();
+    BenchSum();
+    BenchParallelAddition();
+    BenchFixedWidth();
+    BenchFactorial();
+  }
+
+  std::ofstream json;
+  if (!json_path.empty()) {
+    json.open(json_path);
+    if (!json) {
+      std::cerr << "Can not open "s << json_path << endl;
+      return 1;
+    }
+  }
+  BenchScaling(max_digits, json_path.empty() ? nullptr : &json);
+}
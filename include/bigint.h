@@ -1,46 +1,153 @@
 #ifndef BIGINT_H
 #define BIGINT_H
 
+#include <cstdint>
 #include <iostream>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "bigint_limbs.h"
+
 namespace bigint_huawei {
 
 /**
  * BigInt works with integers of any length.
  *
  * Design notes:
- *  BigInt integer is represented as vector of bytes in reverse order
- *  for performance reasons (adding new digit to the end of the vector).
+ *  BigInt integer is represented as vector of limbs in reverse order
+ *  for performance reasons (adding new limb to the end of the vector).
+ *  Each limb is uint32_t and keeps 9 decimal digits (base 10^9), so every
+ *  loop iteration handles 9 digits at once and a sum of two limbs with
+ *  the carry still fits into uint32_t. Decimal base keeps parsing and
+ *  printing linear.
+ *  There are no leading zero limbs, number 0 has no limbs at all.
+ *  Arithmetic on limbs is done by routines from bigint_limbs.h.
+ *
+ *  Small buffer optimization: numbers below 10^38 (up to 38 digits) are
+ *  kept inline in uint128 and limbs stay empty, so short numbers never touch
+ *  the heap and are added with a single native addition. The number spills
+ *  to heap limbs only when it overflows 10^38.
+ *
+ *  Limbs are allocated from std::pmr::memory_resource given to the
+ *  constructor (the default resource otherwise), so a batch of numbers can
+ *  live in a monotonic arena that is released at once. The sum and the
+ *  number read from a stream keep the resource of the left operand, copies
+ *  take the default resource as all pmr containers do.
  *
  * Supports:
  *  - Only natural (positive integers)
  *  - Default constructor that creates number 0
- *  - Constructor that build BigInt from string
+ *  - Constructor that build BigInt from string (std::string_view), digits
+ *    are parsed 8 at a time
  *  - Constructor that build BigInt from long long int
  *  - Reading BigInt from in stream
- *  - Writing BigInt to out stream
+ *  - Writing BigInt to out stream (directly into the stream buffer)
  *  - Add operation for two BigInt numbers
+ *  - In-place add operation, temporaries passed to add operation give their
+ *    buffers to the result (no extra allocations in a running sum)
+ *  - Multiplication: schoolbook for short numbers, Karatsuba and Toom-3
+ *    for longer ones (see limbs::mul)
+ *  - Division with remainder: schoolbook for short divisors, Newton's
+ *    reciprocal for long ones (see limbs::divmod)
+ *  - Exponentiation and modular exponentiation (Montgomery or Barrett
+ *    reduction, sliding window)
+ *  - Greatest common divisor, least common multiple and modular inverse
+ *    (half-GCD for long numbers, Lehmer steps for shorter ones)
+ *  - Comparison operators
  *  - Conversion to string
+ *  - Conversion from and to hexadecimal string and big endian bytes,
+ *    long numbers are split in halves by cached powers 2^(32 * 2^k) and
+ *    combined by fast multiplication (division for the export)
+ *  - Versioned binary format with raw limbs (see bigint_view.h), binary
+ *    numbers are loaded without parsing or used in place by BigIntView
  *
  * All other features will be implemented in the next releases.
  */
 class BigInt {
-  std::vector<uint8_t> digits;
+public:
+  static constexpr uint32_t BASE = limbs::BASE;
+  static constexpr int BASE_DIGITS = 9;
+  static constexpr int SMALL_DIGITS = 38;
+
+private:
+  // value of the number when limbs are empty (number is below SMALL_LIMIT)
+  limbs::uint128 small = 0;
+  std::pmr::vector<uint32_t> limbs;
+
+  bool is_small() const { return limbs.empty(); }
+  const uint32_t *limb_data(uint32_t *buffer, size_t &size) const;
+  void spill();
+  void normalize();
+  size_t digits_count() const;
+  char *format(char *out) const;
+  int compare(const BigInt &number) const;
+  static std::vector<BigInt> word_powers(size_t n);
+  static BigInt from_words(const uint32_t *words, size_t n,
+                           const std::vector<BigInt> &powers);
+  void to_words(uint32_t *words, size_t n,
+                const std::vector<BigInt> &powers) const;
+  std::vector<uint32_t> to_words() const;
 
 public:
   BigInt();
-  BigInt(const std::string &number);
-  BigInt(long long number);
+  BigInt(std::string_view number, std::pmr::memory_resource *resource =
+                                      std::pmr::get_default_resource());
+  BigInt(long long number, std::pmr::memory_resource *resource =
+                               std::pmr::get_default_resource());
+
+  friend class BigIntAccumulator;
+  friend class BigIntView;
 
   friend std::istream &operator>>(std::istream &in, BigInt &number);
   friend std::ostream &operator<<(std::ostream &out, const BigInt &number);
 
-  BigInt operator+(const BigInt &number) const;
+  BigInt &operator+=(const BigInt &number);
+  BigInt operator+(const BigInt &number) const &;
+  BigInt operator+(const BigInt &number) &&;
+  BigInt operator+(BigInt &&number) const &;
+  BigInt operator+(BigInt &&number) &&;
+
+  BigInt &operator*=(const BigInt &number);
+  BigInt operator*(const BigInt &number) const;
+
+  friend std::pair<BigInt, BigInt> divmod(const BigInt &dividend,
+                                          const BigInt &divisor);
+  BigInt &operator/=(const BigInt &number);
+  BigInt operator/(const BigInt &number) const;
+  BigInt &operator%=(const BigInt &number);
+  BigInt operator%(const BigInt &number) const;
+
+  friend BigInt pow(const BigInt &base, uint64_t exponent);
+  friend BigInt powmod(const BigInt &base, const BigInt &exponent,
+                       const BigInt &modulus);
+
+  friend BigInt gcd(const BigInt &first, const BigInt &second);
+  friend BigInt modinv(const BigInt &number, const BigInt &modulus);
+
+  bool operator==(const BigInt &number) const;
+  bool operator!=(const BigInt &number) const;
+  bool operator<(const BigInt &number) const;
+  bool operator<=(const BigInt &number) const;
+  bool operator>(const BigInt &number) const;
+  bool operator>=(const BigInt &number) const;
+
+  std::pmr::memory_resource *resource() const;
 
   std::string to_string() const;
+
+  static BigInt from_hex(std::string_view hex);
+  std::string to_hex() const;
+  static BigInt from_bytes(const uint8_t *bytes, size_t n);
+  std::vector<uint8_t> to_bytes() const;
+
+  void write_binary(std::ostream &out) const;
+  static BigInt read_binary(std::istream &in);
 };
 
+BigInt lcm(const BigInt &first, const BigInt &second);
+
 } // namespace bigint_huawei
 #endif
@@ -0,0 +1,46 @@
+#ifndef BIGINT_ACCUMULATOR_H
+#define BIGINT_ACCUMULATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "bigint.h"
+
+namespace bigint_huawei {
+
+/**
+ * BigIntAccumulator sums many BigInt numbers.
+ *
+ * Design notes:
+ *  Limbs are kept in carry-save form: every limb is uint64_t in base 10^9
+ *  and may grow above the base, so adding a number is a single pass of raw
+ *  limb additions without carries and there are no reallocations once the
+ *  accumulator is as long as the longest operand. Carries are propagated
+ *  once by finish(). A limb takes more than 10^10 additions before it can
+ *  overflow, then the limbs are folded back below the base.
+ *  Numbers below 2^64 (up to 19 digits) are summed separately in uint128
+ *  without splitting into limbs.
+ *
+ * Supports:
+ *  - Adding BigInt numbers
+ *  - Getting the sum (accumulator is reset)
+ */
+class BigIntAccumulator {
+  // (2^64 - 1) / (BASE - 1) additions can not overflow a limb
+  static constexpr uint64_t FOLD_LIMIT = 18000000000ull;
+
+  limbs::uint128 small_sum = 0;
+  std::vector<uint64_t> limbs;
+  uint64_t pending = 0;
+
+  void fold();
+
+public:
+  BigIntAccumulator();
+
+  BigIntAccumulator &operator+=(const BigInt &number);
+  BigInt finish();
+};
+
+} // namespace bigint_huawei
+#endif
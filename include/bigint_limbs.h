@@ -0,0 +1,444 @@
+#ifndef BIGINT_LIMBS_H
+#define BIGINT_LIMBS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "thread_pool.h"
+
+namespace bigint_huawei {
+
+/**
+ * Low level routines that work on raw arrays of limbs in base 10^9.
+ *
+ * They are the building blocks of BigInt operations and know nothing about
+ * BigInt itself: arrays are passed as pointer and size, the least
+ * significant limb goes first. Output arrays must be preallocated by the
+ * caller and may alias the first input.
+ */
+namespace limbs {
+
+constexpr uint32_t BASE = 1000000000;
+
+__extension__ typedef unsigned __int128 uint128;
+
+/**
+ * Numbers below 10^38 fit into uint128 and at most SMALL_LIMBS limbs.
+ */
+constexpr uint128 SMALL_LIMIT =
+    static_cast<uint128>(10000000000000000000ull) * 10000000000000000000ull;
+constexpr size_t SMALL_LIMBS = 5;
+
+/**
+ * Splits number into limbs.
+ *
+ * @param result - must have room for SMALL_LIMBS limbs
+ * @return number of limbs (no leading zero limbs)
+ */
+size_t from_uint128(uint128 number, uint32_t *result);
+
+/**
+ * Combines at most SMALL_LIMBS limbs into a number, the value must be below
+ * SMALL_LIMIT.
+ */
+uint128 to_uint128(const uint32_t *a, size_t n);
+
+/**
+ * Adds two arrays of the same size n and an incoming carry (0 or 1).
+ *
+ * The kernel is picked by cpu_huawei::simd_level():
+ *  - AVX-512 (16 limbs per step)
+ *  - AVX2 (8 limbs per step)
+ *  - SSE2 (4 limbs per step)
+ *  - scalar loop otherwise
+ *
+ * Vector kernels add limbs of a block in parallel and resolve carries
+ * between lanes with a carry-lookahead step on lane bitmasks: every lane
+ * either generates a carry (sum >= BASE), propagates it (sum == BASE - 1)
+ * or kills it, so carries of the whole block are computed by one binary
+ * addition of generate/propagate masks.
+ *
+ * Time complexity: O(n)
+ * @return carry out (0 or 1)
+ */
+uint32_t add_n(const uint32_t *a, const uint32_t *b, uint32_t *result,
+               size_t n, uint32_t carry = 0);
+
+/**
+ * Scalar reference implementation of add_n.
+ */
+uint32_t add_n_scalar(const uint32_t *a, const uint32_t *b, uint32_t *result,
+                      size_t n, uint32_t carry = 0);
+
+/**
+ * Adds array of size n to wide (uint64_t) limbs without carries, the sum
+ * limbs may grow above the base (carry-save form).
+ *
+ * Limbs are widened and added 4 at a time with SSE2 or AVX2 and 8 at a
+ * time with AVX-512 (see cpu_huawei::simd_level()).
+ *
+ * Time complexity: O(n)
+ */
+void add_wide(uint64_t *sum, const uint32_t *a, size_t n);
+
+/**
+ * Operand size (in limbs) from which add() splits the work between threads
+ * of the shared pool, and the smallest block given to a thread.
+ */
+constexpr size_t PARALLEL_ADD_THRESHOLD = size_t(1) << 20;
+constexpr size_t PARALLEL_ADD_BLOCK = size_t(1) << 16;
+
+/**
+ * Adds two arrays of the same size n on the threads of the pool, the result
+ * is the same as add_n.
+ *
+ * Arrays are split into blocks of at least min_block limbs, blocks are added
+ * concurrently without incoming carry. Every block reports its carry out and
+ * whether it propagates a carry (all limbs are BASE - 1). Incoming carries
+ * of blocks are resolved by a scan over the block flags, then blocks with
+ * incoming carry add it concurrently.
+ *
+ * Time complexity: O(n / threads)
+ * @return carry out (0 or 1)
+ */
+uint32_t add_n_parallel(const uint32_t *a, const uint32_t *b, uint32_t *result,
+                        size_t n, uint32_t carry,
+                        thread_pool_huawei::ThreadPool &pool,
+                        size_t min_block = PARALLEL_ADD_BLOCK);
+
+/**
+ * Adds a carry (0 or 1) to the array of size n.
+ *
+ * Carry walks only through the run of BASE - 1 limbs, the rest of the array
+ * is copied as is.
+ *
+ * Time complexity: O(n)
+ * @return carry out (0 or 1)
+ */
+uint32_t add_carry(const uint32_t *a, uint32_t *result, size_t n,
+                   uint32_t carry);
+
+/**
+ * Adds arrays of different sizes, a_size must be not less than b_size.
+ * Result must have room for a_size limbs.
+ *
+ * The common part is added by add_n (add_n_parallel on the shared pool from
+ * PARALLEL_ADD_THRESHOLD limbs), the tail of the longer array only
+ * propagates the carry (no per limb bound checks).
+ *
+ * Time complexity: O(a_size)
+ * @return carry out (0 or 1)
+ */
+uint32_t add(const uint32_t *a, size_t a_size, const uint32_t *b,
+             size_t b_size, uint32_t *result);
+
+/**
+ * Subtracts two arrays of the same size n and an incoming borrow (0 or 1).
+ *
+ * Time complexity: O(n)
+ * @return borrow out (0 or 1)
+ */
+uint32_t sub_n(const uint32_t *a, const uint32_t *b, uint32_t *result,
+               size_t n, uint32_t borrow = 0);
+
+/**
+ * Subtracts b from a, a_size must be not less than b_size.
+ * Result must have room for a_size limbs.
+ *
+ * Time complexity: O(a_size)
+ * @return borrow out (0 or 1), it is 0 when a >= b
+ */
+uint32_t sub(const uint32_t *a, size_t a_size, const uint32_t *b,
+             size_t b_size, uint32_t *result);
+
+/**
+ * Compares two arrays without leading zero limbs.
+ *
+ * Time complexity: O(n)
+ * @return -1, 0 or 1 like strcmp
+ */
+int compare(const uint32_t *a, size_t a_size, const uint32_t *b,
+            size_t b_size);
+
+/**
+ * Size of the array without leading zero limbs.
+ */
+size_t normalized_size(const uint32_t *a, size_t n);
+
+/**
+ * Multiplies array by a single limb.
+ *
+ * Time complexity: O(n)
+ * @return carry out (limb)
+ */
+uint32_t mul_1(const uint32_t *a, size_t n, uint32_t multiplier,
+               uint32_t *result);
+
+/**
+ * Divides array by a single limb (divisor is in [1, BASE)).
+ *
+ * Time complexity: O(n)
+ * @return remainder
+ */
+uint32_t div_1(const uint32_t *a, size_t n, uint32_t divisor,
+               uint32_t *result);
+
+/**
+ * Stack of temporary buffers for recursive algorithms.
+ *
+ * Buffers are handed out and released in LIFO order, memory is kept in a few
+ * large blocks and reused by the deeper levels of recursion, so recursion
+ * itself does not allocate. A new block is allocated only when the current
+ * ones are exhausted.
+ */
+class Scratch {
+  struct Block {
+    std::unique_ptr<uint32_t[]> data;
+    size_t size;
+  };
+  std::vector<Block> blocks;
+  size_t block = 0;
+  size_t offset = 0;
+
+public:
+  struct Mark {
+    size_t block;
+    size_t offset;
+  };
+
+  explicit Scratch(size_t initial_size = 0);
+
+  uint32_t *alloc(size_t n);
+  Mark mark() const { return {block, offset}; }
+  void release(Mark mark) {
+    block = mark.block;
+    offset = mark.offset;
+  }
+};
+
+/**
+ * Releases all buffers taken from scratch within the scope.
+ */
+class ScratchFrame {
+  Scratch &scratch;
+  Scratch::Mark mark;
+
+public:
+  explicit ScratchFrame(Scratch &scratch)
+      : scratch(scratch), mark(scratch.mark()) {}
+  ~ScratchFrame() { scratch.release(mark); }
+  ScratchFrame(const ScratchFrame &) = delete;
+  ScratchFrame &operator=(const ScratchFrame &) = delete;
+};
+
+/**
+ * Operand sizes (in limbs) where multiplication switches from schoolbook
+ * to Karatsuba and from Karatsuba to Toom-3. See bench/bench_bigint.cpp for
+ * the measurements.
+ */
+constexpr size_t KARATSUBA_THRESHOLD = 32;
+constexpr size_t TOOM3_THRESHOLD = 256;
+constexpr size_t NTT_THRESHOLD = 2048;
+
+/**
+ * Largest product size (in limbs) for NTT multiplication: transform length
+ * is limited by the primes and every coefficient of the convolution must
+ * stay below their product.
+ */
+constexpr size_t NTT_MAX_SIZE = size_t(1) << 23;
+
+/**
+ * Schoolbook multiplication, result has room for a_size + b_size limbs
+ * and must not alias the operands.
+ *
+ * Time complexity: O(a_size * b_size)
+ */
+void mul_basecase(const uint32_t *a, size_t a_size, const uint32_t *b,
+                  size_t b_size, uint32_t *result);
+
+/**
+ * One level of Karatsuba multiplication, a_size >= b_size > a_size / 2.
+ *
+ * Operands are split in halves at h = ceil(a_size / 2) limbs and
+ * a * b = z2 * B^2h + ((a0 + a1)(b0 + b1) - z0 - z2) * B^h + z0,
+ * three products instead of four. Products are computed by mul().
+ *
+ * Time complexity: O(n^1.585)
+ */
+void mul_karatsuba(const uint32_t *a, size_t a_size, const uint32_t *b,
+                   size_t b_size, uint32_t *result, Scratch &scratch);
+
+/**
+ * One level of Toom-3 multiplication, a_size >= b_size > 2 * ceil(a_size / 3).
+ *
+ * Operands are split into three parts, evaluated at 0, 1, -1, -2 and
+ * infinity, five products are computed by mul() and the result is
+ * interpolated with Bodrato's sequence (exact divisions by 2 and 3).
+ *
+ * Time complexity: O(n^1.465)
+ */
+void mul_toom3(const uint32_t *a, size_t a_size, const uint32_t *b,
+               size_t b_size, uint32_t *result, Scratch &scratch);
+
+/**
+ * Number theoretic transform multiplication, a_size + b_size must not exceed
+ * NTT_MAX_SIZE.
+ *
+ * Limbs are convolved modulo three primes below 2^30 (998244353, 167772161,
+ * 469762049) with Montgomery arithmetic, the exact coefficients are restored
+ * with the Chinese remainder theorem (Garner's algorithm) and carried into
+ * limbs. There is no floating point, so there is no rounding risk. The
+ * transforms are cache blocked: levels above 2^15 elements are done
+ * recursively, everything below runs inside the cache.
+ *
+ * Result has room for a_size + b_size limbs and must not alias operands.
+ * Squaring (same operands) needs one forward transform less.
+ *
+ * Time complexity: O(n log n)
+ */
+void mul_ntt(const uint32_t *a, size_t a_size, const uint32_t *b,
+             size_t b_size, uint32_t *result, Scratch &scratch);
+
+/**
+ * Multiplies two arrays picking the algorithm by operand sizes:
+ * schoolbook, Karatsuba, Toom-3 or NTT. Unbalanced operands are multiplied
+ * by chunks of the shorter operand size (NTT takes them as is), products
+ * too long for NTT are split by Toom-3 first.
+ *
+ * Result has room for a_size + b_size limbs and must not alias operands.
+ */
+void mul(const uint32_t *a, size_t a_size, const uint32_t *b, size_t b_size,
+         uint32_t *result, Scratch &scratch);
+void mul(const uint32_t *a, size_t a_size, const uint32_t *b, size_t b_size,
+         uint32_t *result);
+
+/**
+ * Divisor size (in limbs) where division switches from schoolbook (Knuth's
+ * algorithm D) to Newton's reciprocal. See bench/bench_bigint.cpp for the
+ * measurements.
+ */
+constexpr size_t DIV_NEWTON_THRESHOLD = 768;
+
+/**
+ * Schoolbook division (Knuth's algorithm D), a_size >= b_size >= 2, b has
+ * no leading zero limbs.
+ *
+ * Quotient has room for a_size - b_size + 1 limbs, remainder for b_size
+ * limbs, both must not alias operands.
+ *
+ * Time complexity: O((a_size - b_size + 1) * b_size)
+ */
+void divmod_knuth(const uint32_t *a, size_t a_size, const uint32_t *b,
+                  size_t b_size, uint32_t *quotient, uint32_t *remainder,
+                  Scratch &scratch);
+
+/**
+ * Computes x = floor(B^(2n) / v) for v of n limbs without leading zero limbs.
+ *
+ * Reciprocal of the top n / 2 + 2 limbs is computed recursively and one
+ * Newton step x1 = x0 + x0 * (B^(2n) - v * x0) / B^(2n) doubles the number
+ * of correct limbs, the last units are fixed by the exact residual.
+ *
+ * Time complexity: O(M(n)), M is the cost of multiplication
+ * @param x - must have room for n + 3 limbs
+ * @return size of x without leading zero limbs
+ */
+size_t reciprocal(const uint32_t *v, size_t n, uint32_t *x, Scratch &scratch);
+
+/**
+ * Division by Newton's reciprocal, a_size >= b_size, same contract as
+ * divmod_knuth.
+ *
+ * Dividend is processed by blocks of b_size limbs from the top: quotient of
+ * every block is estimated by one multiplication with the reciprocal, is at
+ * most 2 below the real one and is fixed by the remainder.
+ *
+ * Time complexity: O(a_size / b_size * M(b_size))
+ */
+void divmod_newton(const uint32_t *a, size_t a_size, const uint32_t *b,
+                   size_t b_size, uint32_t *quotient, uint32_t *remainder,
+                   Scratch &scratch);
+
+/**
+ * Divides arrays picking the algorithm by operand sizes: single limb
+ * division, schoolbook or Newton's reciprocal. Same contract as
+ * divmod_newton.
+ */
+void divmod(const uint32_t *a, size_t a_size, const uint32_t *b, size_t b_size,
+            uint32_t *quotient, uint32_t *remainder, Scratch &scratch);
+void divmod(const uint32_t *a, size_t a_size, const uint32_t *b, size_t b_size,
+            uint32_t *quotient, uint32_t *remainder);
+
+/**
+ * Modular exponentiation result = base^exponent mod m, m has n limbs without
+ * leading zero limbs and is greater than 1, base has n limbs (leading zero
+ * limbs allowed) and is less than m. Result has room for n limbs.
+ *
+ * Exponent is converted to binary and processed by sliding windows of up to
+ * 6 bits. Products are reduced without division: by Montgomery reduction
+ * when m is coprime with the base (not divisible by 2 and 5), by Barrett
+ * reduction with the precomputed reciprocal of m otherwise.
+ *
+ * Time complexity: O(k * M(n)) where k is a number of exponent bits
+ */
+void powmod(const uint32_t *base, const uint32_t *exponent,
+            size_t exponent_size, const uint32_t *modulus, size_t n,
+            uint32_t *result);
+
+/**
+ * Binary numbers up to this size (in 32-bit words) are converted to and from
+ * limbs by the schoolbook algorithms, longer ones are split in halves.
+ */
+constexpr size_t RADIX_THRESHOLD = 64;
+
+/**
+ * Converts n binary words (base 2^32, the lowest word first) to limbs by
+ * Horner's scheme, one pass over the limbs per word.
+ *
+ * Time complexity: O(n^2)
+ * @param result - must have room for n + n / 8 + 2 limbs
+ * @return number of limbs (no leading zero limbs)
+ */
+size_t from_binary(const uint32_t *words, size_t n, uint32_t *result);
+
+/**
+ * Converts limbs to n binary words (base 2^32, the lowest word first) by
+ * repeated division by 2^32, the number must be below 2^(32n). Limbs are
+ * destroyed.
+ *
+ * Time complexity: O(size * n)
+ */
+void to_binary(uint32_t *a, size_t size, uint32_t *words, size_t n);
+
+/**
+ * Parses n decimal digits (no sign, no spaces) into ceil(n / 9) limbs.
+ *
+ * Every full limb is one digit plus 8 digits validated and converted at once
+ * with SWAR arithmetic on a 64-bit word, only the top limb is parsed digit
+ * by digit. With AVX2 (see cpu_huawei::simd_level()) 4 limbs are converted
+ * per step.
+ *
+ * Time complexity: O(n)
+ * @return false if there is a non digit character
+ */
+bool parse_decimal(const char *digits, size_t n, uint32_t *result);
+
+/**
+ * Writes limb as exactly 9 digits padded with zeroes, two digits per step.
+ *
+ * @return pointer past the last written character
+ */
+char *format_limb(uint32_t limb, char *out);
+
+/**
+ * Writes limb without leading zeroes (the top limb of a number).
+ *
+ * @return pointer past the last written character
+ */
+char *format_top_limb(uint32_t limb, char *out);
+
+} // namespace limbs
+} // namespace bigint_huawei
+#endif
@@ -0,0 +1,41 @@
+#ifndef BIGINT_STREAM_H
+#define BIGINT_STREAM_H
+
+#include <cstddef>
+#include <string>
+
+namespace bigint_huawei {
+
+/**
+ * Default number of digits processed at once by add_files.
+ */
+constexpr size_t STREAM_CHUNK_DIGITS = size_t(1) << 22;
+
+/**
+ * Adds two decimal numbers stored in files and writes the sum to the output
+ * file, numbers may be larger than memory.
+ *
+ * Design notes:
+ *  Input files are memory mapped and walked from the least significant end
+ *  in chunks of chunk_digits digits, every chunk of the sum is written at
+ *  its final offset with pwrite, pages of the processed chunks are dropped.
+ *  The length of the sum (carry out of the top digit) is known in advance
+ *  from a scan of the top digits: the carry goes out only if the first
+ *  position from the top where the digits do not sum to 9 sums to 10 or more.
+ *  So peak memory is O(chunk_digits) whatever the length of the numbers.
+ *
+ * Input files contain a natural number, leading zeroes and surrounding
+ * whitespaces are allowed. The output file gets the sum and a new line.
+ *
+ * Time complexity: O(n) where n is a number of digits
+ * Space complexity: O(chunk_digits)
+ * @throws std::invalid_argument if a file has anything but a number, the
+ * output file is one of the inputs or chunk_digits is 0
+ * @throws std::runtime_error if a file can not be read or written
+ */
+void add_files(const std::string &first_path, const std::string &second_path,
+               const std::string &output_path,
+               size_t chunk_digits = STREAM_CHUNK_DIGITS);
+
+} // namespace bigint_huawei
+#endif
@@ -0,0 +1,45 @@
+#ifndef BIGINT_TREE_H
+#define BIGINT_TREE_H
+
+#include <vector>
+
+#include "bigint.h"
+#include "thread_pool.h"
+
+namespace bigint_huawei {
+
+/**
+ * Product of all numbers, the product of an empty sequence is 1.
+ *
+ * Numbers are multiplied by a balanced tree: neighbours are multiplied in
+ * pairs, then the pairs and so on, so operands of every product are of about
+ * the same size and take fast multiplication (Karatsuba, Toom-3, NTT)
+ * instead of the quadratic left to right fold. The sequence is split into
+ * blocks that are reduced on the pool, then independent products of every
+ * upper level of the tree run in parallel.
+ *
+ * Time complexity: O(M(n) log k) where n is a number of limbs of the
+ * product and k is a number of numbers
+ * Space complexity: O(n) where n is a number of limbs of the product
+ */
+BigInt product_tree(const std::vector<BigInt> &numbers,
+                    thread_pool_huawei::ThreadPool &pool =
+                        thread_pool_huawei::ThreadPool::shared());
+
+/**
+ * Sum of all numbers, the sum of an empty sequence is 0.
+ *
+ * Blocks of the sequence are summed on the pool by carry-save accumulators
+ * (see BigIntAccumulator), then the block sums are added by a balanced
+ * tree.
+ *
+ * Time complexity: O(N) where N is a total number of limbs
+ * Space complexity: O(n * p) where n is a number of limbs of the sum and p
+ * is a number of threads
+ */
+BigInt sum_tree(const std::vector<BigInt> &numbers,
+                thread_pool_huawei::ThreadPool &pool =
+                    thread_pool_huawei::ThreadPool::shared());
+
+} // namespace bigint_huawei
+#endif
@@ -0,0 +1,68 @@
+#ifndef BIGINT_VIEW_H
+#define BIGINT_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bigint.h"
+
+namespace bigint_huawei {
+
+/**
+ * Binary format of BigInt (BigInt::write_binary):
+ *  bytes 0..3   - magic "BIGI"
+ *  bytes 4..7   - format version, uint32_t little endian
+ *  bytes 8..15  - number of limbs n, uint64_t little endian
+ *  bytes 16..   - n limbs in base 10^9, uint32_t little endian, the lowest
+ *                 limb goes first and the top limb is not zero
+ * Number 0 has no limbs. The header keeps limbs 4 byte aligned, so limbs of
+ * a page aligned buffer (mmap) are used in place.
+ */
+constexpr char BINARY_MAGIC[4] = {'B', 'I', 'G', 'I'};
+constexpr uint32_t BINARY_VERSION = 1;
+constexpr size_t BINARY_HEADER_SIZE = 16;
+
+/**
+ * BigIntView is a read-only number over limbs in BigInt binary format owned
+ * by someone else (usually a memory mapped file).
+ *
+ * Design notes:
+ *  The view keeps only the pointer to the limbs and their count, nothing is
+ *  parsed or copied, so a cached number is loaded at the cost of a header
+ *  check and one pass over the limbs. The buffer must outlive the view.
+ *
+ * Supports:
+ *  - Creating the view from a buffer with binary BigInt
+ *  - Adding views and BigInt numbers into a new BigInt
+ *  - Conversion to BigInt
+ */
+class BigIntView {
+  const uint32_t *limbs = nullptr;
+  size_t count = 0;
+
+  static const uint32_t *limb_data(const BigInt &number, uint32_t *buffer,
+                                   size_t &size);
+  static BigInt sum(const uint32_t *a, size_t a_size, const uint32_t *b,
+                    size_t b_size);
+
+public:
+  BigIntView() = default;
+
+  static BigIntView from_buffer(const void *buffer, size_t size);
+
+  /**
+   * Size of the number in binary format, the view ends there.
+   */
+  size_t binary_size() const;
+  size_t size() const { return count; }
+  const uint32_t *data() const { return limbs; }
+
+  BigInt to_bigint() const;
+
+  friend BigInt operator+(const BigIntView &first, const BigIntView &second);
+  friend BigInt operator+(const BigIntView &first, const BigInt &second);
+  friend BigInt operator+(const BigInt &first, const BigIntView &second);
+};
+
+} // namespace bigint_huawei
+#endif
@@ -0,0 +1,53 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+namespace cpu_huawei {
+
+/**
+ * Instruction sets that hot kernels have variants for, every level includes
+ * the ones below it.
+ */
+enum class SimdLevel { scalar, sse2, avx2, avx512 };
+
+/**
+ * Number of levels, kernel tables are indexed by the level.
+ */
+constexpr int SIMD_LEVELS = 4;
+
+/**
+ * Name of the environment variable that lowers the level picked at startup
+ * ("scalar", "sse2", "avx2" or "avx512"), used to test and compare kernels
+ * on one machine. Unknown values are ignored.
+ */
+constexpr char SIMD_ENV[] = "HUAWEI_SIMD";
+
+/**
+ * The best level supported by the CPU (cpuid), detected once.
+ */
+SimdLevel detected_simd_level();
+
+/**
+ * Level used by the dispatched kernels.
+ *
+ * Design notes:
+ *  The level is picked once, on the first call: the detected level lowered
+ *  by SIMD_ENV if it is set. Kernels look their variant up in a table
+ *  indexed by the level, so every call costs one indirect branch that is
+ *  always predicted. Variants are compiled with target attributes, so the
+ *  binary is built for the generic target and still runs everywhere.
+ */
+SimdLevel simd_level();
+
+/**
+ * Overrides the level of the dispatched kernels, the level is lowered to
+ * the detected one. Meant for tests and benchmarks: kernels that run at the
+ * same time may still use the previous level.
+ *
+ * @return the level actually set
+ */
+SimdLevel set_simd_level(SimdLevel level);
+
+const char *simd_level_name(SimdLevel level);
+
+} // namespace cpu_huawei
+#endif
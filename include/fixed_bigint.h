@@ -0,0 +1,317 @@
+#ifndef FIXED_BIGINT_H
+#define FIXED_BIGINT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "bigint.h"
+
+namespace bigint_huawei {
+
+/**
+ * FixedBigInt works with natural numbers below 2^Bits.
+ *
+ * Design notes:
+ *  The number is std::array of Bits / 64 binary limbs in reverse order, so
+ *  it never touches the heap and its size is known to the compiler: loops
+ *  over the limbs are fully unrolled. Arithmetic wraps around modulo 2^Bits
+ *  like unsigned built-in types, use it for values with a known upper bound
+ *  (hashes, keys, moduli) and BigInt for everything else.
+ *  All arithmetic is constexpr, so constants are computed at compile time.
+ *  At run time the carry chain is built with add-with-carry intrinsics, at
+ *  compile time (__builtin_is_constant_evaluated) with portable code.
+ *
+ * Supports:
+ *  - Default constructor that creates number 0
+ *  - Constructor from uint64_t
+ *  - Constructor from decimal string (std::string_view), also constexpr
+ *  - Conversion from and to BigInt
+ *  - Add, subtract and multiply operations (modulo 2^Bits)
+ *  - Comparison operators
+ *  - Conversion to string and writing to out stream
+ */
+template <size_t Bits> class FixedBigInt {
+  static_assert(Bits > 0 && Bits % 64 == 0, "Bits must be a multiple of 64");
+
+public:
+  static constexpr size_t LIMBS = Bits / 64;
+
+private:
+  static constexpr uint64_t POWER_19 = 10000000000000000000ull;
+  std::array<uint64_t, LIMBS> limbs{};
+
+  /**
+   * Returns a + b + carry, carry is updated.
+   */
+  static constexpr uint64_t add_carry(uint64_t a, uint64_t b,
+                                      unsigned char &carry) {
+#if defined(__x86_64__)
+    if (!__builtin_is_constant_evaluated()) {
+      unsigned long long sum = 0;
+      carry = _addcarry_u64(carry, a, b, &sum);
+      return sum;
+    }
+#endif
+    uint64_t sum = a + b;
+    unsigned char carry_out = sum < a;
+    sum += carry;
+    carry = carry_out | (sum < carry);
+    return sum;
+  }
+
+  /**
+   * Returns a - b - borrow, borrow is updated.
+   */
+  static constexpr uint64_t sub_borrow(uint64_t a, uint64_t b,
+                                       unsigned char &borrow) {
+#if defined(__x86_64__)
+    if (!__builtin_is_constant_evaluated()) {
+      unsigned long long difference = 0;
+      borrow = _subborrow_u64(borrow, a, b, &difference);
+      return difference;
+    }
+#endif
+    uint64_t difference = a - b;
+    unsigned char borrow_out = a < b;
+    uint64_t result = difference - borrow;
+    borrow = borrow_out | (difference < borrow);
+    return result;
+  }
+
+  /**
+   * this = this * factor + addend, returns the limb shifted out.
+   */
+  constexpr uint64_t mul_add_1(uint64_t factor, uint64_t addend) {
+    uint64_t carry = addend;
+#pragma GCC unroll 16
+    for (size_t i = 0; i < LIMBS; ++i) {
+      limbs::uint128 t =
+          static_cast<limbs::uint128>(limbs[i]) * factor + carry;
+      limbs[i] = static_cast<uint64_t>(t);
+      carry = static_cast<uint64_t>(t >> 64);
+    }
+    return carry;
+  }
+
+  /**
+   * this = this / divisor, returns the remainder.
+   */
+  constexpr uint64_t div_1(uint64_t divisor) {
+    limbs::uint128 remainder = 0;
+    for (size_t i = LIMBS; i > 0; --i) {
+      limbs::uint128 current = (remainder << 64) | limbs[i - 1];
+      limbs[i - 1] = static_cast<uint64_t>(current / divisor);
+      remainder = current % divisor;
+    }
+    return static_cast<uint64_t>(remainder);
+  }
+
+  static std::invalid_argument overflow_error() {
+    return std::invalid_argument("Number does not fit into " +
+                                 std::to_string(Bits) + " bits");
+  }
+
+public:
+  constexpr FixedBigInt() = default;
+  constexpr FixedBigInt(uint64_t number) { limbs[0] = number; }
+
+  /**
+   * Parses decimal number, digits are collected 19 at a time into a limb
+   * and merged into the number by one multiply-add pass.
+   *
+   * Time complexity: O(n * LIMBS / 19) where n is a number of digits
+   * Space complexity: O(1)
+   *
+   * @throws std::invalid_argument if the string has non-digit characters or
+   * the number does not fit into Bits
+   */
+  constexpr explicit FixedBigInt(std::string_view number) {
+    for (size_t i = 0; i < number.size();) {
+      uint64_t group = 0, power = 1;
+      for (size_t end = i + 19; i < end && i < number.size(); ++i) {
+        if (number[i] < '0' || number[i] > '9') {
+          throw std::invalid_argument("Expected positive integer, got " +
+                                      std::string(number));
+        }
+        group = group * 10 + (number[i] - '0');
+        power *= 10;
+      }
+      if (mul_add_1(power, group) != 0) {
+        throw overflow_error();
+      }
+    }
+  }
+
+  /**
+   * Converts BigInt number through its binary bytes.
+   *
+   * @throws std::invalid_argument if the number does not fit into Bits
+   */
+  explicit FixedBigInt(const BigInt &number) {
+    std::vector<uint8_t> bytes = number.to_bytes();
+    if (bytes.size() > 8 * LIMBS) {
+      throw overflow_error();
+    }
+    for (size_t i = 0; i < bytes.size(); ++i) {
+      limbs[i / 8] |= static_cast<uint64_t>(bytes[bytes.size() - 1 - i])
+                      << (8 * (i % 8));
+    }
+  }
+
+  BigInt to_bigint() const {
+    std::array<uint8_t, 8 * LIMBS> bytes{};
+    for (size_t i = 0; i < 8 * LIMBS; ++i) {
+      bytes[8 * LIMBS - 1 - i] =
+          static_cast<uint8_t>(limbs[i / 8] >> (8 * (i % 8)));
+    }
+    return BigInt::from_bytes(bytes.data(), bytes.size());
+  }
+
+  /**
+   * Limb of the number, limb 0 is the lowest one.
+   */
+  constexpr uint64_t limb(size_t i) const { return limbs[i]; }
+
+  constexpr bool is_zero() const {
+    uint64_t bits = 0;
+#pragma GCC unroll 16
+    for (size_t i = 0; i < LIMBS; ++i) {
+      bits |= limbs[i];
+    }
+    return bits == 0;
+  }
+
+  /**
+   * Time complexity: O(LIMBS)
+   * Space complexity: O(1)
+   */
+  constexpr FixedBigInt &operator+=(const FixedBigInt &number) {
+    unsigned char carry = 0;
+#pragma GCC unroll 16
+    for (size_t i = 0; i < LIMBS; ++i) {
+      limbs[i] = add_carry(limbs[i], number.limbs[i], carry);
+    }
+    return *this;
+  }
+
+  constexpr FixedBigInt operator+(const FixedBigInt &number) const {
+    FixedBigInt result = *this;
+    return result += number;
+  }
+
+  /**
+   * Time complexity: O(LIMBS)
+   * Space complexity: O(1)
+   */
+  constexpr FixedBigInt &operator-=(const FixedBigInt &number) {
+    unsigned char borrow = 0;
+#pragma GCC unroll 16
+    for (size_t i = 0; i < LIMBS; ++i) {
+      limbs[i] = sub_borrow(limbs[i], number.limbs[i], borrow);
+    }
+    return *this;
+  }
+
+  constexpr FixedBigInt operator-(const FixedBigInt &number) const {
+    FixedBigInt result = *this;
+    return result -= number;
+  }
+
+  /**
+   * Schoolbook product, the limbs above Bits are never computed.
+   *
+   * Time complexity: O(LIMBS^2)
+   * Space complexity: O(1)
+   */
+  constexpr FixedBigInt operator*(const FixedBigInt &number) const {
+    FixedBigInt result;
+#pragma GCC unroll 16
+    for (size_t i = 0; i < LIMBS; ++i) {
+      uint64_t carry = 0;
+#pragma GCC unroll 16
+      for (size_t j = 0; i + j < LIMBS; ++j) {
+        limbs::uint128 t =
+            static_cast<limbs::uint128>(limbs[i]) * number.limbs[j] +
+            result.limbs[i + j] + carry;
+        result.limbs[i + j] = static_cast<uint64_t>(t);
+        carry = static_cast<uint64_t>(t >> 64);
+      }
+    }
+    return result;
+  }
+
+  constexpr FixedBigInt &operator*=(const FixedBigInt &number) {
+    return *this = *this * number;
+  }
+
+  constexpr bool operator==(const FixedBigInt &number) const {
+    uint64_t difference = 0;
+#pragma GCC unroll 16
+    for (size_t i = 0; i < LIMBS; ++i) {
+      difference |= limbs[i] ^ number.limbs[i];
+    }
+    return difference == 0;
+  }
+
+  constexpr bool operator<(const FixedBigInt &number) const {
+    unsigned char borrow = 0;
+#pragma GCC unroll 16
+    for (size_t i = 0; i < LIMBS; ++i) {
+      sub_borrow(limbs[i], number.limbs[i], borrow);
+    }
+    return borrow != 0;
+  }
+
+  constexpr bool operator!=(const FixedBigInt &number) const {
+    return !(*this == number);
+  }
+  constexpr bool operator>(const FixedBigInt &number) const {
+    return number < *this;
+  }
+  constexpr bool operator<=(const FixedBigInt &number) const {
+    return !(number < *this);
+  }
+  constexpr bool operator>=(const FixedBigInt &number) const {
+    return !(*this < number);
+  }
+
+  /**
+   * Time complexity: O(LIMBS^2)
+   * Space complexity: O(LIMBS)
+   */
+  std::string to_string() const {
+    if (is_zero()) {
+      return "0";
+    }
+    // Groups of 19 digits, the lowest one goes first
+    FixedBigInt number = *this;
+    std::vector<uint64_t> groups;
+    while (!number.is_zero()) {
+      groups.push_back(number.div_1(POWER_19));
+    }
+    std::string result = std::to_string(groups.back());
+    for (size_t i = groups.size() - 1; i > 0; --i) {
+      std::string group = std::to_string(groups[i - 1]);
+      result.append(19 - group.size(), '0').append(group);
+    }
+    return result;
+  }
+
+  friend std::ostream &operator<<(std::ostream &out,
+                                  const FixedBigInt &number) {
+    return out << number.to_string();
+  }
+};
+
+} // namespace bigint_huawei
+#endif
@@ -2,8 +2,11 @@
 #define GREATEST_NUMBER_H
 
 #include <algorithm>
+#include <cstddef>
 #include <vector>
 
+#include "thread_pool.h"
+
 namespace gn_huawei {
 
 /**
@@ -12,27 +15,78 @@ namespace gn_huawei {
  *
  * Note: input array of numbers is modified (sorted)
  *
- * The below algorithm finds all two sums first and saves them.
- * Then it sums two sums and updates better maximum.
- *
- * Two optimize performance, sorting is used for:
- *  - To detect earlier if we can get out of loop
- *  - To use binary search to reduce two sums operations
- *
- * Time complexity: O((N^2)logN) where N is a number of numbers.
- * Details:
- *  - Sorting takes O(NlogN) where N is a number of numbers
- *  - Finding all two sums takes N(N+1)/2 => O(N^2) where N is a number of
- * numbers
- *  - Sorting all two sums takes O(N^2logN) because there are N(N+1)/2 two sums
- * in array
- *  - Finding sums of two sums takes (N^2)log(N^2) => O((N^2)logN) where N is a
- * number of numbers
- *
- * Space complexity: O(N^2) where N is a number of numbers because we store all
- * two sums
+ * Two engines answer the question, the cheaper one for the input is used:
+ *  - two sums: all sums of one or two numbers are sorted and combined by a
+ *    two pointer sweep, O(N^2) time and memory
+ *  - bitset: sums of at most 4 numbers are marked in a bitset of limit
+ *    bits by 4 layers of shifts, O(D * L / 64) time and O(L / 8) memory
+ * The bitset wins when the limit is small: its shifts cost D * L / 64 word
+ * operations per layer, two sums cost the number of two sums not above the
+ * limit (counted exactly in O(N)).
+ *
+ * Time complexity: O(NlogN + min(N^2, D * L / 64)) where N is a number of
+ * numbers, D is a number of distinct numbers and L is the limit
+ * Space complexity: O(N^2) for two sums or O(L / 8) for the bitset
+ *
+ * @throws std::invalid_argument if a number is negative
  */
 int FindGreatestNumber(std::vector<int> &numbers, int limit);
 
+/**
+ * FindGreatestNumber on the threads of the pool, the result is the same.
+ *
+ * The two sums engine builds rows of two sums in blocks, sorts them by a
+ * parallel radix sort and splits the sweep into ranges of first sums with
+ * local bests. A range that hits the limit exactly stops the others through
+ * an atomic flag. The bitset engine (small limits) runs on the calling
+ * thread.
+ *
+ * Note: input array of numbers is modified (sorted)
+ *
+ * Time complexity: O(NlogN + min(N^2 / P, D * L / 64)) where N is a number
+ * of numbers, P is a number of threads, D is a number of distinct numbers
+ * and L is the limit
+ * Space complexity: O(N^2) for two sums or O(L / 8) for the bitset
+ *
+ * @throws std::invalid_argument if a number is negative
+ */
+int FindGreatestNumberParallel(std::vector<int> &numbers, int limit,
+                               thread_pool_huawei::ThreadPool &pool =
+                                   thread_pool_huawei::ThreadPool::shared());
+
+/**
+ * GreatestNumberIndex answers FindGreatestNumber for many limits against the
+ * same numbers.
+ *
+ * Design notes:
+ *  The index keeps sorted unique sums of at most two distinct numbers,
+ *  including 0 (nothing picked), so every answer is a sum of two stored
+ *  sums. The sums are built once for O(D^2) time and memory where D is a
+ *  number of distinct numbers, then a query is a two pointer sweep
+ *  over them. A batch of limits is answered by one sweep: every stored sum
+ *  is read once as the first sum, and every limit keeps its own second
+ *  pointer that only moves down, so a batch of Q limits costs O(Q * S) for
+ *  S stored sums plus sorting the limits.
+ *
+ * Supports:
+ *  - Building the index from numbers (not negative)
+ *  - Answering one limit
+ *  - Answering a batch of limits
+ */
+class GreatestNumberIndex {
+  std::vector<unsigned int> sums;
+
+public:
+  explicit GreatestNumberIndex(const std::vector<int> &numbers);
+
+  /**
+   * Number of stored sums.
+   */
+  size_t size() const { return sums.size(); }
+
+  int find(int limit) const;
+  std::vector<int> find(const std::vector<int> &limits) const;
+};
+
 } // namespace gn_huawei
 #endif
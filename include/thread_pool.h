@@ -0,0 +1,54 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace thread_pool_huawei {
+
+/**
+ * ThreadPool runs tasks on a fixed set of worker threads.
+ *
+ * Design notes:
+ *  Workers take tasks from a single queue guarded by a mutex, tasks are
+ *  expected to be coarse (blocks of thousands of elements), so the queue is
+ *  not a bottleneck. parallel_for hands out indices through an atomic
+ *  counter and the calling thread works too, so nested calls from a task can
+ *  not deadlock and a pool with busy workers still makes progress.
+ *  Tasks must not throw.
+ *
+ * Supports:
+ *  - Submitting a task
+ *  - Parallel loop over indices that waits for all of them
+ *  - Shared pool with a worker per hardware thread
+ */
+class ThreadPool {
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> tasks;
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool stopping = false;
+
+  void work();
+
+public:
+  explicit ThreadPool(size_t threads);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t size() const { return workers.size(); }
+
+  void submit(std::function<void()> task);
+  void parallel_for(size_t count, const std::function<void(size_t)> &body);
+
+  static ThreadPool &shared();
+};
+
+} // namespace thread_pool_huawei
+#endif
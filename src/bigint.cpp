@@ -1,5 +1,8 @@
 #include "bigint.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace bigint_huawei {
 
 using namespace std::literals::string_literals;
@@ -13,66 +16,182 @@ BigInt::BigInt() {}
 /**
  * Constructor that builds BigInt from string representation.
  *
+ * Digits are converted and validated 8 at a time straight into limbs
+ * (see limbs::parse_decimal). Numbers with up to SMALL_DIGITS significant
+ * digits are parsed into a stack buffer and kept inline, longer numbers
+ * take limbs from the resource.
+ *
  * Time complexity: O(n) where n is a number of digits
- * Space complexity: O(n) where n is a number of digits
+ * Space complexity: O(n / BASE_DIGITS) where n is a number of digits
  */
-BigInt::BigInt(const string &number) {
+BigInt::BigInt(std::string_view number, std::pmr::memory_resource *resource)
+    : limbs(resource) {
 
   // Handle leading zeroes
-  int first_non_zero_idx = 0;
-  while (first_non_zero_idx < static_cast<int>(number.size()) and
+  size_t first_non_zero_idx = 0;
+  while (first_non_zero_idx < number.size() and
          number[first_non_zero_idx] == '0') {
     ++first_non_zero_idx;
   }
 
   // all zeroes string case
-  if (first_non_zero_idx == static_cast<int>(number.size())) {
+  if (first_non_zero_idx == number.size()) {
     return;
   }
 
-  for (int i = number.size() - 1; i >= first_non_zero_idx; --i) {
-    if (number[i] - '0' < 0 || number[i] - '0' > 9) {
-      throw std::invalid_argument("Expected positive integer, got "s + number +
-                                  " (-->'"s + number[i] + "')"s);
+  size_t digits_count = number.size() - first_non_zero_idx;
+  size_t limbs_count = (digits_count + BASE_DIGITS - 1) / BASE_DIGITS;
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  uint32_t *result = buffer;
+  if (digits_count > SMALL_DIGITS) {
+    limbs.resize(limbs_count);
+    result = limbs.data();
+  }
+
+  if (!limbs::parse_decimal(number.data() + first_non_zero_idx, digits_count,
+                            result)) {
+    // Report the last bad character
+    size_t i = number.size() - 1;
+    while (number[i] >= '0' && number[i] <= '9') {
+      --i;
     }
-    digits.push_back(number[i] - '0');
+    throw std::invalid_argument("Expected positive integer, got "s +
+                                string(number) + " (-->'"s + number[i] +
+                                "')"s);
+  }
+
+  if (result == buffer) {
+    small = limbs::to_uint128(buffer, limbs_count);
   }
 }
 
 /**
  * Constructor that builds BigInt from long long.
  *
- * Time complexity: O(n) where n is a number of digits
- * Space complexity: O(n) where n is a number of digits
+ * Any long long fits inline, so it is just an assignment. The resource is
+ * kept for the limbs the number may get later.
+ *
+ * Time complexity: O(1)
+ * Space complexity: O(1)
  */
-BigInt::BigInt(long long number) {
+BigInt::BigInt(long long number, std::pmr::memory_resource *resource)
+    : limbs(resource) {
   if (number < 0) {
     throw std::invalid_argument("Expected positive integer, got "s +
                                 std::to_string(number));
   }
 
-  while (number != 0) {
-    digits.push_back(number % 10);
-    number /= 10;
+  small = number;
+}
+
+/**
+ * Returns limbs of the number. Inline number is split into the buffer that
+ * must have room for SMALL_LIMBS limbs.
+ *
+ * Time complexity: O(1)
+ */
+const uint32_t *BigInt::limb_data(uint32_t *buffer, size_t &size) const {
+  if (is_small()) {
+    size = limbs::from_uint128(small, buffer);
+    return buffer;
   }
+  size = limbs.size();
+  return limbs.data();
 }
 
 /**
- * Converts BigInt into string.
+ * Moves inline number to the heap limbs. Number 0 gets a single zero limb,
+ * it is the only case when the top limb can be zero and it is fixed by
+ * normalize().
  *
- * Time complexity: O(n) where n is a number of digits
- * Space complexity: O(n) where n is a number of digits (to accumulate string)
+ * Time complexity: O(1)
  */
-string BigInt::to_string() const {
+void BigInt::spill() {
+  if (!is_small()) {
+    return;
+  }
+  uint32_t buffer[limbs::SMALL_LIMBS] = {0};
+  size_t size = limbs::from_uint128(small, buffer);
+  limbs.assign(buffer, buffer + std::max<size_t>(size, 1));
+  small = 0;
+}
 
-  if (this->digits.empty()) {
-    return "0"s;
+/**
+ * Removes leading zero limbs and moves the number inline when it fits.
+ * Heap buffer is kept for reuse.
+ *
+ * Time complexity: O(n) where n is a number of leading zero limbs
+ */
+void BigInt::normalize() {
+  while (!limbs.empty() && limbs.back() == 0) {
+    limbs.pop_back();
+  }
+  // The top limb of 5 stands for 10^36, so 10^38 is 100 there
+  if (!limbs.empty() && (limbs.size() < limbs::SMALL_LIMBS ||
+                         (limbs.size() == limbs::SMALL_LIMBS &&
+                          limbs.back() < 100))) {
+    small = limbs::to_uint128(limbs.data(), limbs.size());
+    limbs.clear();
   }
+}
 
-  string number;
-  for (int i = this->digits.size() - 1; i >= 0; --i) {
-    number.push_back(this->digits[i] + '0');
+/**
+ * Memory resource the limbs are allocated from.
+ */
+std::pmr::memory_resource *BigInt::resource() const {
+  return limbs.get_allocator().resource();
+}
+
+/**
+ * Number of decimal digits of the number.
+ *
+ * Time complexity: O(1)
+ */
+size_t BigInt::digits_count() const {
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  size_t size;
+  const uint32_t *data = limb_data(buffer, size);
+  if (size == 0) {
+    return 1;
+  }
+  char top[BASE_DIGITS];
+  return (size - 1) * BASE_DIGITS +
+         (limbs::format_top_limb(data[size - 1], top) - top);
+}
+
+/**
+ * Writes digits of the number to out, there must be room for digits_count()
+ * characters.
+ *
+ * Time complexity: O(n) where n is a number of digits
+ */
+char *BigInt::format(char *out) const {
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  size_t size;
+  const uint32_t *data = limb_data(buffer, size);
+  if (size == 0) {
+    *out++ = '0';
+    return out;
+  }
+  out = limbs::format_top_limb(data[size - 1], out);
+  for (size_t i = size - 1; i > 0; --i) {
+    out = limbs::format_limb(data[i - 1], out);
   }
+  return out;
+}
+
+/**
+ * Converts BigInt into string.
+ *
+ * The most significant limb is written as is, all others are padded
+ * with zeroes up to BASE_DIGITS digits.
+ *
+ * Time complexity: O(n) where n is a number of digits
+ * Space complexity: O(n) where n is a number of digits (to accumulate string)
+ */
+string BigInt::to_string() const {
+  string number(digits_count(), '0');
+  format(number.data());
   return number;
 }
 
@@ -83,51 +202,591 @@ string BigInt::to_string() const {
  * Space complexity: O(n) where n is a number of digits
  */
 std::istream &operator>>(std::istream &in, BigInt &number) {
-  string input;
+  std::pmr::string input(number.resource());
   in >> input;
-  number = BigInt(input);
+  number = BigInt(input, number.resource());
   return in;
 }
 
 /**
  * Write BigInt to out stream.
  *
- * Time complexity: O(n) where n is a number of digits (converting BigInt into
- * string) Space complexity: O(n) where n is a number of digits
+ * Limbs are formatted into a small stack buffer that is flushed straight to
+ * the stream buffer, no intermediate string is built. Padding requested by
+ * std::setw is applied by the regular string output.
+ *
+ * Time complexity: O(n) where n is a number of digits
+ * Space complexity: O(1)
  */
 std::ostream &operator<<(std::ostream &out, const BigInt &number) {
-  out << number.to_string();
+  if (out.width() > 0) {
+    return out << number.to_string();
+  }
+
+  std::ostream::sentry guard(out);
+  if (!guard) {
+    return out;
+  }
+
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  size_t size;
+  const uint32_t *data = number.limb_data(buffer, size);
+
+  constexpr size_t CHUNK_LIMBS = 64;
+  char chunk[CHUNK_LIMBS * BigInt::BASE_DIGITS];
+  char *end = chunk;
+  bool ok = true;
+  if (size == 0) {
+    *end++ = '0';
+  } else {
+    end = limbs::format_top_limb(data[size - 1], end);
+    for (size_t i = size - 1; i > 0; --i) {
+      if (end + BigInt::BASE_DIGITS > chunk + sizeof(chunk)) {
+        ok &= out.rdbuf()->sputn(chunk, end - chunk) == end - chunk;
+        end = chunk;
+      }
+      end = limbs::format_limb(data[i - 1], end);
+    }
+  }
+  ok &= out.rdbuf()->sputn(chunk, end - chunk) == end - chunk;
+
+  if (!ok) {
+    out.setstate(std::ios_base::badbit);
+  }
   return out;
 }
 
+/**
+ * Adds BigInt number to this one in place.
+ *
+ * Two inline numbers are added natively, their sum is below 2 * 10^38 and
+ * fits uint128. Otherwise the number spills to the heap, capacity for
+ * max(len) + 1 limbs is reserved at once, so the carry never reallocates the
+ * buffer. Limbs are added by the vectorized kernel (see bigint_limbs.h)
+ * directly into this number's buffer.
+ *
+ * Time complexity: O(n) where n is a number of limbs of largest number
+ * Space complexity: O(1) amortized (buffer grows only when number gets longer)
+ */
+BigInt &BigInt::operator+=(const BigInt &number) {
+  if (this->is_small() && number.is_small()) {
+    limbs::uint128 sum = this->small + number.small;
+    if (sum < limbs::SMALL_LIMIT) {
+      this->small = sum;
+      return *this;
+    }
+    uint32_t buffer[limbs::SMALL_LIMBS];
+    size_t size = limbs::from_uint128(sum, buffer);
+    this->limbs.assign(buffer, buffer + size);
+    this->small = 0;
+    return *this;
+  }
+
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  size_t number_size;
+  const uint32_t *number_data = number.limb_data(buffer, number_size);
+
+  spill();
+  size_t size = std::max(this->limbs.size(), number_size);
+  if (this->limbs.capacity() < size + 1) {
+    this->limbs.reserve(size + 1);
+    // self addition: buffer of the number was just reallocated
+    if (&number == this) {
+      number_data = this->limbs.data();
+    }
+  }
+
+  uint32_t overflow;
+  if (this->limbs.size() >= number_size) {
+    overflow = limbs::add(this->limbs.data(), this->limbs.size(), number_data,
+                          number_size, this->limbs.data());
+  } else {
+    // Zero padded to the longer number, so the output aliases the first input
+    this->limbs.resize(size);
+    overflow = limbs::add(this->limbs.data(), size, number_data, number_size,
+                          this->limbs.data());
+  }
+
+  if (overflow) {
+    this->limbs.push_back(1);
+  }
+  normalize();
+
+  return *this;
+}
+
 /**
  * Adds two BigInt numbers
  *
- * Time complexity: O(n) where n is a number of digits of largest number
- * Space complexity: O(n) where n is a number of digits of largest number
+ * Inline numbers take the native fast path, otherwise limbs are added by the
+ * vectorized kernel (see bigint_limbs.h), the tail of the longer number only
+ * propagates the carry.
+ *
+ * Time complexity: O(n) where n is a number of limbs of largest number
+ * Space complexity: O(n) where n is a number of limbs of largest number
+ */
+BigInt BigInt::operator+(const BigInt &number) const & {
+  if (this->is_small() && number.is_small()) {
+    // Not a copy: the spilled limbs must come from the left operand resource
+    BigInt result(0, resource());
+    result.small = small;
+    result += number;
+    return result;
+  }
+
+  uint32_t this_buffer[limbs::SMALL_LIMBS], number_buffer[limbs::SMALL_LIMBS];
+  size_t this_size, number_size;
+  const uint32_t *this_data = this->limb_data(this_buffer, this_size);
+  const uint32_t *number_data = number.limb_data(number_buffer, number_size);
+  if (this_size < number_size) {
+    std::swap(this_data, number_data);
+    std::swap(this_size, number_size);
+  }
+
+  BigInt result(0, resource());
+  result.limbs.resize(this_size + 1);
+  uint32_t overflow = limbs::add(this_data, this_size, number_data,
+                                 number_size, result.limbs.data());
+
+  if (overflow) {
+    result.limbs.back() = 1;
+  } else {
+    result.limbs.pop_back();
+  }
+
+  return result;
+}
+
+/**
+ * Adds BigInt number to the temporary reusing the temporary's buffer.
+ *
+ * Time complexity: O(n) where n is a number of limbs of largest number
+ * Space complexity: O(1) amortized
+ */
+BigInt BigInt::operator+(const BigInt &number) && {
+  *this += number;
+  return std::move(*this);
+}
+
+/**
+ * Adds temporary BigInt number reusing its buffer.
+ *
+ * Time complexity: O(n) where n is a number of limbs of largest number
+ * Space complexity: O(1) amortized
+ */
+BigInt BigInt::operator+(BigInt &&number) const & {
+  number += *this;
+  return std::move(number);
+}
+
+/**
+ * Adds two temporaries reusing the buffer with larger capacity.
+ *
+ * Time complexity: O(n) where n is a number of limbs of largest number
+ * Space complexity: O(1) amortized
+ */
+BigInt BigInt::operator+(BigInt &&number) && {
+  if (number.limbs.capacity() > this->limbs.capacity()) {
+    number += *this;
+    return std::move(number);
+  }
+  *this += number;
+  return std::move(*this);
+}
+
+/**
+ * Multiplies two BigInt numbers
+ *
+ * Two inline numbers below 2^64 are multiplied natively. Otherwise limbs are
+ * multiplied by limbs::mul that picks schoolbook, Karatsuba or Toom-3
+ * multiplication by operand sizes.
+ *
+ * Time complexity: O(n^1.465) for large balanced numbers where n is a number
+ * of limbs
+ * Space complexity: O(n) where n is a number of limbs
+ */
+BigInt BigInt::operator*(const BigInt &number) const {
+  BigInt result;
+  if (this->is_small() && number.is_small() && (this->small >> 64) == 0 &&
+      (number.small >> 64) == 0) {
+    limbs::uint128 product = this->small * number.small;
+    if (product < limbs::SMALL_LIMIT) {
+      result.small = product;
+      return result;
+    }
+  }
+
+  uint32_t this_buffer[limbs::SMALL_LIMBS], number_buffer[limbs::SMALL_LIMBS];
+  size_t this_size, number_size;
+  const uint32_t *this_data = this->limb_data(this_buffer, this_size);
+  const uint32_t *number_data = number.limb_data(number_buffer, number_size);
+  if (this_size == 0 || number_size == 0) {
+    return result;
+  }
+
+  result.limbs.resize(this_size + number_size);
+  limbs::mul(this_data, this_size, number_data, number_size,
+             result.limbs.data());
+  result.normalize();
+  return result;
+}
+
+/**
+ * Multiplies this number by BigInt number.
+ *
+ * Time complexity: see operator*
+ */
+BigInt &BigInt::operator*=(const BigInt &number) {
+  *this = *this * number;
+  return *this;
+}
+
+/**
+ * Divides two BigInt numbers, returns quotient and remainder.
+ *
+ * Two inline numbers are divided natively, a dividend less than the divisor
+ * is the remainder itself. Otherwise limbs are divided by limbs::divmod that
+ * picks single limb, schoolbook or Newton division by operand sizes.
+ *
+ * Time complexity: O(n / m * M(m)) for large numbers where n and m are
+ * numbers of limbs of dividend and divisor, M is the cost of multiplication
+ * Space complexity: O(n) where n is a number of limbs
+ * @throws std::invalid_argument on division by zero
+ */
+std::pair<BigInt, BigInt> divmod(const BigInt &dividend,
+                                 const BigInt &divisor) {
+  if (divisor.is_small() && divisor.small == 0) {
+    throw std::invalid_argument("Division by zero"s);
+  }
+
+  BigInt quotient, remainder;
+  if (dividend.is_small() && divisor.is_small()) {
+    quotient.small = dividend.small / divisor.small;
+    remainder.small = dividend.small % divisor.small;
+    return {quotient, remainder};
+  }
+  if (dividend < divisor) {
+    return {quotient, dividend};
+  }
+
+  uint32_t dividend_buffer[limbs::SMALL_LIMBS];
+  uint32_t divisor_buffer[limbs::SMALL_LIMBS];
+  size_t dividend_size, divisor_size;
+  const uint32_t *dividend_data =
+      dividend.limb_data(dividend_buffer, dividend_size);
+  const uint32_t *divisor_data = divisor.limb_data(divisor_buffer, divisor_size);
+
+  quotient.limbs.resize(dividend_size - divisor_size + 1);
+  remainder.limbs.resize(divisor_size);
+  limbs::divmod(dividend_data, dividend_size, divisor_data, divisor_size,
+                quotient.limbs.data(), remainder.limbs.data());
+  quotient.normalize();
+  remainder.normalize();
+  return {std::move(quotient), std::move(remainder)};
+}
+
+/**
+ * Divides this number by BigInt number (integer division).
+ *
+ * Time complexity: see divmod
+ */
+BigInt BigInt::operator/(const BigInt &number) const {
+  return divmod(*this, number).first;
+}
+
+BigInt &BigInt::operator/=(const BigInt &number) {
+  *this = divmod(*this, number).first;
+  return *this;
+}
+
+/**
+ * Remainder of division of this number by BigInt number.
+ *
+ * Time complexity: see divmod
  */
-BigInt BigInt::operator+(const BigInt &number) const {
+BigInt BigInt::operator%(const BigInt &number) const {
+  return divmod(*this, number).second;
+}
+
+BigInt &BigInt::operator%=(const BigInt &number) {
+  *this = divmod(*this, number).second;
+  return *this;
+}
+
+/**
+ * Raises BigInt number to the power, left to right binary exponentiation.
+ *
+ * Time complexity: O(M(n)) where n is a number of limbs of the result
+ * Space complexity: O(n) where n is a number of limbs of the result
+ */
+BigInt pow(const BigInt &base, uint64_t exponent) {
+  BigInt result(1);
+  for (int bit = 63; bit >= 0; --bit) {
+    result *= result;
+    if ((exponent >> bit) & 1) {
+      result *= base;
+    }
+  }
+  return result;
+}
+
+/**
+ * Raises BigInt number to the power modulo BigInt number.
+ *
+ * Base is reduced once by division, then every step is reduced without
+ * division (see limbs::powmod).
+ *
+ * Time complexity: O(k * M(n)) where k is a number of exponent bits and n is
+ * a number of limbs of the modulus
+ * Space complexity: O(n) where n is a number of limbs of the modulus
+ * @throws std::invalid_argument if modulus is 0
+ */
+BigInt powmod(const BigInt &base, const BigInt &exponent,
+              const BigInt &modulus) {
+  if (modulus == BigInt(0)) {
+    throw std::invalid_argument("Modulus must be positive"s);
+  }
   BigInt result;
+  if (modulus == BigInt(1)) {
+    return result;
+  }
+
+  BigInt reduced = base % modulus;
+  uint32_t modulus_buffer[limbs::SMALL_LIMBS];
+  uint32_t base_buffer[limbs::SMALL_LIMBS];
+  uint32_t exponent_buffer[limbs::SMALL_LIMBS];
+  size_t modulus_size, base_size, exponent_size;
+  const uint32_t *modulus_data =
+      modulus.limb_data(modulus_buffer, modulus_size);
+  const uint32_t *base_data = reduced.limb_data(base_buffer, base_size);
+  const uint32_t *exponent_data =
+      exponent.limb_data(exponent_buffer, exponent_size);
+
+  std::vector<uint32_t> padded_base(modulus_size, 0);
+  std::copy(base_data, base_data + base_size, padded_base.begin());
+  result.limbs.resize(modulus_size);
+  limbs::powmod(padded_base.data(), exponent_data, exponent_size,
+                modulus_data, modulus_size, result.limbs.data());
+  result.normalize();
+  return result;
+}
+
+/**
+ * Compares two BigInt numbers.
+ *
+ * Inline numbers are always less than heap ones, so only numbers of the same
+ * kind are compared by value.
+ *
+ * Time complexity: O(n) where n is a number of limbs
+ * @return -1, 0 or 1 like strcmp
+ */
+int BigInt::compare(const BigInt &number) const {
+  if (this->is_small() && number.is_small()) {
+    return (this->small > number.small) - (this->small < number.small);
+  }
+  if (this->is_small() != number.is_small()) {
+    return this->is_small() ? -1 : 1;
+  }
+  return limbs::compare(this->limbs.data(), this->limbs.size(),
+                        number.limbs.data(), number.limbs.size());
+}
+
+bool BigInt::operator==(const BigInt &number) const {
+  return compare(number) == 0;
+}
+
+bool BigInt::operator!=(const BigInt &number) const {
+  return compare(number) != 0;
+}
+
+bool BigInt::operator<(const BigInt &number) const {
+  return compare(number) < 0;
+}
 
-  uint8_t overflow = 0;
-  size_t i = 0;
-  while (i < this->digits.size() || i < number.digits.size()) {
-    int sum = overflow;
-    if (i < this->digits.size()) {
-      sum += this->digits[i];
+bool BigInt::operator<=(const BigInt &number) const {
+  return compare(number) <= 0;
+}
+
+bool BigInt::operator>(const BigInt &number) const {
+  return compare(number) > 0;
+}
+
+bool BigInt::operator>=(const BigInt &number) const {
+  return compare(number) >= 0;
+}
+
+/**
+ * Powers 2^(32 * 2^k) for all 2^k below n words, they split binary numbers
+ * of n words in halves.
+ *
+ * Time complexity: O(M(n)) where M is the cost of multiplication
+ */
+std::vector<BigInt> BigInt::word_powers(size_t n) {
+  std::vector<BigInt> powers;
+  if (n > limbs::RADIX_THRESHOLD) {
+    powers.push_back(BigInt(1ll << 32));
+    while ((size_t(1) << powers.size()) < n) {
+      powers.push_back(powers.back() * powers.back());
+    }
+  }
+  return powers;
+}
+
+/**
+ * Builds BigInt from n binary words (the lowest word first): the high part
+ * is multiplied by the power that matches the length of the low part.
+ *
+ * Time complexity: O(M(n) log n) where M is the cost of multiplication
+ */
+BigInt BigInt::from_words(const uint32_t *words, size_t n,
+                          const std::vector<BigInt> &powers) {
+  while (n > 0 && words[n - 1] == 0) {
+    --n;
+  }
+  BigInt result;
+  if (n <= limbs::RADIX_THRESHOLD) {
+    result.limbs.resize(n + n / 8 + 2);
+    result.limbs.resize(limbs::from_binary(words, n, result.limbs.data()));
+    result.normalize();
+    return result;
+  }
+
+  size_t level = 0;
+  while ((size_t(2) << level) < n) {
+    ++level;
+  }
+  size_t half = size_t(1) << level;
+  result = from_words(words + half, n - half, powers) * powers[level];
+  result += from_words(words, half, powers);
+  return result;
+}
+
+/**
+ * Writes the number as n binary words (the lowest word first), the number
+ * must be below 2^(32n): quotient and remainder of the division by the power
+ * give the high and the low part.
+ *
+ * Time complexity: O(M(n) log n) where M is the cost of multiplication
+ */
+void BigInt::to_words(uint32_t *words, size_t n,
+                      const std::vector<BigInt> &powers) const {
+  if (n <= limbs::RADIX_THRESHOLD) {
+    uint32_t buffer[limbs::SMALL_LIMBS];
+    size_t size;
+    const uint32_t *data = limb_data(buffer, size);
+    std::vector<uint32_t> copy(data, data + size);
+    limbs::to_binary(copy.data(), size, words, n);
+    return;
+  }
+
+  size_t level = 0;
+  while ((size_t(2) << level) < n) {
+    ++level;
+  }
+  size_t half = size_t(1) << level;
+  auto [high, low] = divmod(*this, powers[level]);
+  low.to_words(words, half, powers);
+  high.to_words(words + half, n - half, powers);
+}
+
+/**
+ * Binary words of the number without leading zero words.
+ */
+std::vector<uint32_t> BigInt::to_words() const {
+  // 10^9 < 2^30, so every limb takes less than 30 bits
+  size_t size = is_small() ? limbs::SMALL_LIMBS : limbs.size();
+  size_t n = (size * 30 + 31) / 32;
+  std::vector<uint32_t> words(n);
+  to_words(words.data(), n, word_powers(n));
+  while (!words.empty() && words.back() == 0) {
+    words.pop_back();
+  }
+  return words;
+}
+
+/**
+ * Builds BigInt from hexadecimal string (no prefix, any case).
+ *
+ * Time complexity: O(M(n) log n) where n is a number of digits
+ * Space complexity: O(n) where n is a number of digits
+ * @throws std::invalid_argument if there is a non hexadecimal character
+ */
+BigInt BigInt::from_hex(std::string_view hex) {
+  std::vector<uint32_t> words((hex.size() + 7) / 8);
+  for (size_t i = 0; i < hex.size(); ++i) {
+    char digit = hex[hex.size() - 1 - i];
+    uint32_t value;
+    if (digit >= '0' && digit <= '9') {
+      value = digit - '0';
+    } else if (digit >= 'a' && digit <= 'f') {
+      value = digit - 'a' + 10;
+    } else if (digit >= 'A' && digit <= 'F') {
+      value = digit - 'A' + 10;
+    } else {
+      throw std::invalid_argument("Expected hexadecimal integer, got "s +
+                                  string(hex) + " (-->'"s + digit + "')"s);
     }
-    if (i < number.digits.size()) {
-      sum += number.digits[i];
+    words[i / 8] |= value << (4 * (i % 8));
+  }
+  return from_words(words.data(), words.size(), word_powers(words.size()));
+}
+
+/**
+ * Converts BigInt to hexadecimal string (lower case, no prefix).
+ *
+ * Time complexity: O(M(n) log n) where n is a number of limbs
+ * Space complexity: O(n) where n is a number of limbs
+ */
+string BigInt::to_hex() const {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  std::vector<uint32_t> words = to_words();
+  if (words.empty()) {
+    return "0"s;
+  }
+  string result;
+  result.reserve(words.size() * 8);
+  for (size_t i = words.size(); i > 0; --i) {
+    for (int shift = 28; shift >= 0; shift -= 4) {
+      result += HEX_DIGITS[(words[i - 1] >> shift) & 0xf];
     }
-    result.digits.push_back(sum % 10);
-    overflow = sum / 10;
-    ++i;
   }
+  result.erase(0, result.find_first_not_of('0'));
+  return result;
+}
 
-  if (overflow) {
-    result.digits.push_back(1);
+/**
+ * Builds BigInt from big endian bytes.
+ *
+ * Time complexity: O(M(n) log n) where n is a number of bytes
+ * Space complexity: O(n) where n is a number of bytes
+ */
+BigInt BigInt::from_bytes(const uint8_t *bytes, size_t n) {
+  std::vector<uint32_t> words((n + 3) / 4);
+  for (size_t i = 0; i < n; ++i) {
+    words[i / 4] |= static_cast<uint32_t>(bytes[n - 1 - i]) << (8 * (i % 4));
   }
+  return from_words(words.data(), words.size(), word_powers(words.size()));
+}
 
+/**
+ * Converts BigInt to big endian bytes without leading zero bytes, number 0
+ * has no bytes at all.
+ *
+ * Time complexity: O(M(n) log n) where n is a number of limbs
+ * Space complexity: O(n) where n is a number of limbs
+ */
+std::vector<uint8_t> BigInt::to_bytes() const {
+  std::vector<uint32_t> words = to_words();
+  std::vector<uint8_t> result;
+  result.reserve(words.size() * 4);
+  for (size_t i = words.size(); i > 0; --i) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      uint8_t byte = words[i - 1] >> shift;
+      if (!result.empty() || byte != 0) {
+        result.push_back(byte);
+      }
+    }
+  }
   return result;
 }
 
@@ -0,0 +1,82 @@
+#include "bigint_accumulator.h"
+
+namespace bigint_huawei {
+
+/**
+ * Default constructor, the sum is 0.
+ */
+BigIntAccumulator::BigIntAccumulator() {}
+
+/**
+ * Propagates carries so every limb is below BASE again.
+ *
+ * Time complexity: O(n) where n is a number of limbs
+ */
+void BigIntAccumulator::fold() {
+  uint64_t carry = 0;
+  for (uint64_t &limb : limbs) {
+    uint64_t current = limb % BigInt::BASE + carry;
+    carry = limb / BigInt::BASE + current / BigInt::BASE;
+    limb = current % BigInt::BASE;
+  }
+  while (carry > 0) {
+    limbs.push_back(carry % BigInt::BASE);
+    carry /= BigInt::BASE;
+  }
+  pending = 0;
+}
+
+/**
+ * Adds BigInt number to the sum.
+ *
+ * Time complexity: O(n) where n is a number of limbs of the number, O(1)
+ * for numbers below 2^64
+ * Space complexity: O(1) when the accumulator is not shorter than the number
+ */
+BigIntAccumulator &BigIntAccumulator::operator+=(const BigInt &number) {
+  if (number.is_small() && (number.small >> 64) == 0) {
+    small_sum += number.small;
+    return *this;
+  }
+
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  size_t size;
+  const uint32_t *data = number.limb_data(buffer, size);
+  if (pending == FOLD_LIMIT) {
+    fold();
+  }
+  if (limbs.size() < size) {
+    limbs.resize(size, 0);
+  }
+  limbs::add_wide(limbs.data(), data, size);
+  ++pending;
+  return *this;
+}
+
+/**
+ * Returns the sum and resets the accumulator to 0.
+ *
+ * Time complexity: O(n) where n is a number of limbs
+ * Space complexity: O(n) where n is a number of limbs
+ */
+BigInt BigIntAccumulator::finish() {
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  size_t small_size = limbs::from_uint128(small_sum, buffer);
+  if (limbs.size() < small_size) {
+    limbs.resize(small_size, 0);
+  }
+  for (size_t i = 0; i < small_size; ++i) {
+    limbs[i] += buffer[i];
+  }
+  fold();
+
+  BigInt result;
+  result.limbs.assign(limbs.begin(), limbs.end());
+  result.normalize();
+
+  small_sum = 0;
+  limbs.clear();
+  return result;
+}
+
+} // namespace bigint_huawei
@@ -0,0 +1,194 @@
+#include "bigint_view.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace bigint_huawei {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "Binary BigInt format keeps limbs as they are in memory");
+
+using namespace std::literals::string_literals;
+
+namespace {
+
+/**
+ * Parses the header and returns the number of limbs.
+ *
+ * @throws std::invalid_argument if the magic or the version is wrong
+ */
+uint64_t ParseHeader(const char *header) {
+  if (std::memcmp(header, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+    throw std::invalid_argument("Expected binary BigInt, got wrong magic"s);
+  }
+  uint32_t version;
+  uint64_t count;
+  std::memcpy(&version, header + 4, sizeof(version));
+  std::memcpy(&count, header + 8, sizeof(count));
+  if (version != BINARY_VERSION) {
+    throw std::invalid_argument("Unsupported binary BigInt version "s +
+                                std::to_string(version));
+  }
+  return count;
+}
+
+/**
+ * Checks that every limb is below the base and the top one is not zero.
+ *
+ * @throws std::invalid_argument if the limbs do not form a number
+ */
+void CheckLimbs(const uint32_t *limbs, size_t count) {
+  uint32_t top = 0;
+  for (size_t i = 0; i < count; ++i) {
+    top = std::max(top, limbs[i]);
+  }
+  if (top >= limbs::BASE || (count > 0 && limbs[count - 1] == 0)) {
+    throw std::invalid_argument("Expected binary BigInt, got malformed limbs"s);
+  }
+}
+
+} // namespace
+
+/**
+ * Writes the number in binary format (see bigint_view.h).
+ *
+ * Time complexity: O(n) where n is a number of limbs
+ * Space complexity: O(1)
+ */
+void BigInt::write_binary(std::ostream &out) const {
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  size_t size;
+  const uint32_t *data = limb_data(buffer, size);
+
+  char header[BINARY_HEADER_SIZE];
+  uint64_t count = size;
+  std::memcpy(header, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+  std::memcpy(header + 4, &BINARY_VERSION, sizeof(BINARY_VERSION));
+  std::memcpy(header + 8, &count, sizeof(count));
+  out.write(header, sizeof(header));
+  out.write(reinterpret_cast<const char *>(data), size * sizeof(uint32_t));
+}
+
+/**
+ * Reads the number in binary format (see bigint_view.h), limbs are read
+ * straight into the number.
+ *
+ * Time complexity: O(n) where n is a number of limbs
+ * Space complexity: O(n) where n is a number of limbs
+ *
+ * @throws std::invalid_argument if the data is not a binary BigInt
+ * @throws std::runtime_error if the stream ends too early
+ */
+BigInt BigInt::read_binary(std::istream &in) {
+  char header[BINARY_HEADER_SIZE];
+  if (!in.read(header, sizeof(header))) {
+    throw std::runtime_error("Unexpected end of binary BigInt"s);
+  }
+  uint64_t count = ParseHeader(header);
+
+  // Limbs are read by blocks, so a corrupted count does not allocate more
+  // than the stream really has
+  constexpr size_t BLOCK = size_t(1) << 20;
+  BigInt result;
+  for (uint64_t done = 0; done < count;) {
+    size_t block = std::min<uint64_t>(BLOCK, count - done);
+    result.limbs.resize(done + block);
+    if (!in.read(reinterpret_cast<char *>(result.limbs.data() + done),
+                 block * sizeof(uint32_t))) {
+      throw std::runtime_error("Unexpected end of binary BigInt"s);
+    }
+    done += block;
+  }
+  CheckLimbs(result.limbs.data(), result.limbs.size());
+  result.normalize();
+  return result;
+}
+
+/**
+ * Creates the view over binary BigInt at the start of the buffer, the buffer
+ * may go on after the number (see binary_size).
+ *
+ * Time complexity: O(n) where n is a number of limbs (validation)
+ * Space complexity: O(1)
+ *
+ * @throws std::invalid_argument if the buffer is not a binary BigInt or is
+ * not 4 byte aligned
+ */
+BigIntView BigIntView::from_buffer(const void *buffer, size_t size) {
+  if (size < BINARY_HEADER_SIZE) {
+    throw std::invalid_argument("Expected binary BigInt, got "s +
+                                std::to_string(size) + " bytes"s);
+  }
+  if (reinterpret_cast<uintptr_t>(buffer) % alignof(uint32_t) != 0) {
+    throw std::invalid_argument("Binary BigInt buffer is not aligned"s);
+  }
+  const char *bytes = static_cast<const char *>(buffer);
+  uint64_t count = ParseHeader(bytes);
+  if (count > (size - BINARY_HEADER_SIZE) / sizeof(uint32_t)) {
+    throw std::invalid_argument("Expected binary BigInt, got truncated limbs"s);
+  }
+
+  BigIntView view;
+  view.limbs = reinterpret_cast<const uint32_t *>(bytes + BINARY_HEADER_SIZE);
+  view.count = count;
+  CheckLimbs(view.limbs, view.count);
+  return view;
+}
+
+size_t BigIntView::binary_size() const {
+  return BINARY_HEADER_SIZE + count * sizeof(uint32_t);
+}
+
+/**
+ * Time complexity: O(n) where n is a number of limbs
+ * Space complexity: O(n) where n is a number of limbs
+ */
+BigInt BigIntView::to_bigint() const {
+  BigInt result;
+  result.limbs.assign(limbs, limbs + count);
+  result.normalize();
+  return result;
+}
+
+const uint32_t *BigIntView::limb_data(const BigInt &number, uint32_t *buffer,
+                                      size_t &size) {
+  return number.limb_data(buffer, size);
+}
+
+/**
+ * Adds limbs of two numbers into a new BigInt.
+ *
+ * Time complexity: O(max(a_size, b_size))
+ * Space complexity: O(max(a_size, b_size))
+ */
+BigInt BigIntView::sum(const uint32_t *a, size_t a_size, const uint32_t *b,
+                       size_t b_size) {
+  if (a_size < b_size) {
+    std::swap(a, b);
+    std::swap(a_size, b_size);
+  }
+  BigInt result;
+  result.limbs.resize(a_size + 1);
+  result.limbs.back() = limbs::add(a, a_size, b, b_size, result.limbs.data());
+  result.normalize();
+  return result;
+}
+
+BigInt operator+(const BigIntView &first, const BigIntView &second) {
+  return BigIntView::sum(first.limbs, first.count, second.limbs, second.count);
+}
+
+BigInt operator+(const BigIntView &first, const BigInt &second) {
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  size_t size;
+  const uint32_t *data = BigIntView::limb_data(second, buffer, size);
+  return BigIntView::sum(first.limbs, first.count, data, size);
+}
+
+BigInt operator+(const BigInt &first, const BigIntView &second) {
+  return second + first;
+}
+
+} // namespace bigint_huawei
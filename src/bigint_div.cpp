@@ -0,0 +1,304 @@
+#include "bigint_limbs.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bigint_huawei {
+namespace limbs {
+
+namespace {
+
+/**
+ * Multiplies and returns the size of the product without leading zeroes.
+ */
+size_t MulNormalized(const uint32_t *a, size_t a_size, const uint32_t *b,
+                     size_t b_size, uint32_t *result, Scratch &scratch) {
+  a_size = normalized_size(a, a_size);
+  b_size = normalized_size(b, b_size);
+  mul(a, a_size, b, b_size, result, scratch);
+  return normalized_size(result, a_size + b_size);
+}
+
+/**
+ * Adds or subtracts one, the array must have room for a carry.
+ */
+void Increment(uint32_t *a, size_t &size) {
+  a[size] = 0;
+  uint32_t one = 1;
+  add(a, size + 1, &one, 1, a);
+  size = normalized_size(a, size + 1);
+}
+
+void Decrement(uint32_t *a, size_t &size) {
+  uint32_t one = 1;
+  sub(a, size, &one, 1, a);
+  size = normalized_size(a, size);
+}
+
+/**
+ * Makes x = floor(B^(2n) / v) out of its approximation:
+ * residual B^(2n) - v * x is moved into [0, v) by small steps.
+ */
+void CorrectReciprocal(const uint32_t *v, size_t n, uint32_t *x,
+                       size_t &x_size, Scratch &scratch) {
+  ScratchFrame frame(scratch);
+  uint32_t *power = scratch.alloc(2 * n + 1);
+  std::fill(power, power + 2 * n, 0);
+  power[2 * n] = 1;
+
+  // x has at most n + 2 limbs and its top limbs are small, they are added
+  // by single limb products so the multiplication stays n by n
+  uint32_t *product = scratch.alloc(2 * n + 3);
+  size_t low_size = std::min(x_size, n);
+  std::fill(product, product + 2 * n + 3, 0);
+  MulNormalized(v, n, x, low_size, product, scratch);
+  uint32_t *row = scratch.alloc(n + 1);
+  for (size_t i = n; i < x_size; ++i) {
+    row[n] = mul_1(v, n, x[i], row);
+    add(product + i, 2 * n + 3 - i, row, n + 1, product + i);
+  }
+  size_t product_size = normalized_size(product, 2 * n + 3);
+
+  // residual = |B^(2n) - v * x|
+  size_t size = std::max(product_size, 2 * n + 1);
+  uint32_t *residual = scratch.alloc(size);
+  size_t residual_size;
+  bool negative = compare(product, product_size, power, 2 * n + 1) > 0;
+  if (negative) {
+    sub(product, product_size, power, 2 * n + 1, residual);
+    residual_size = normalized_size(residual, product_size);
+  } else {
+    sub(power, 2 * n + 1, product, product_size, residual);
+    residual_size = normalized_size(residual, 2 * n + 1);
+  }
+
+  while (negative && residual_size > 0) {
+    Decrement(x, x_size);
+    if (compare(residual, residual_size, v, n) > 0) {
+      sub(residual, residual_size, v, n, residual);
+      residual_size = normalized_size(residual, residual_size);
+    } else {
+      sub(v, n, residual, residual_size, residual);
+      residual_size = normalized_size(residual, n);
+      negative = false;
+    }
+  }
+  while (compare(residual, residual_size, v, n) >= 0) {
+    sub(residual, residual_size, v, n, residual);
+    residual_size = normalized_size(residual, residual_size);
+    Increment(x, x_size);
+  }
+}
+
+/**
+ * Approximates floor(B^(2n) / v) up to a few units, only the top level
+ * result is corrected by the residual (see reciprocal()).
+ */
+size_t ApproximateReciprocal(const uint32_t *v, size_t n, uint32_t *x,
+                             Scratch &scratch) {
+  ScratchFrame frame(scratch);
+  if (n < DIV_NEWTON_THRESHOLD) {
+    uint32_t *power = scratch.alloc(2 * n + 1);
+    std::fill(power, power + 2 * n, 0);
+    power[2 * n] = 1;
+    uint32_t *remainder = scratch.alloc(n);
+    divmod(power, 2 * n + 1, v, n, x, remainder, scratch);
+    return normalized_size(x, n + 2);
+  }
+
+  // x0 = floor(B^(2h) / v_top) * B^(n - h) approximates B^(2n) / v with
+  // about h - 2 correct limbs, 2 limbs of h are the guard
+  size_t h = n / 2 + 2;
+  size_t shift = n - h;
+  uint32_t *x_top = scratch.alloc(h + 3);
+  size_t x_top_size = ApproximateReciprocal(v + shift, h, x_top, scratch);
+
+  // Newton step x1 = x0 + x0 * (B^(2n) - v * x0) / B^(2n), with x0 written
+  // as x_top * B^shift it is x1 = x0 + x_top * error / B^(2h) where
+  // error = B^(n + h) - v * x_top
+  uint32_t *product = scratch.alloc(n + x_top_size);
+  size_t product_size =
+      MulNormalized(v, n, x_top, x_top_size, product, scratch);
+
+  size_t power_size = n + h + 1;
+  uint32_t *power = scratch.alloc(power_size);
+  std::fill(power, power + power_size - 1, 0);
+  power[power_size - 1] = 1;
+  uint32_t *error = scratch.alloc(std::max(product_size, power_size));
+  size_t error_size;
+  bool negative = compare(product, product_size, power, power_size) > 0;
+  if (negative) {
+    sub(product, product_size, power, power_size, error);
+    error_size = normalized_size(error, product_size);
+  } else {
+    sub(power, power_size, product, product_size, error);
+    error_size = normalized_size(error, power_size);
+  }
+
+  // The lowest h - 4 limbs of the error change the result by less than a
+  // unit, they are not multiplied
+  size_t cut = std::min(h - 4, error_size);
+  uint32_t *correction = scratch.alloc(x_top_size + error_size - cut + 1);
+  size_t correction_size = MulNormalized(x_top, x_top_size, error + cut,
+                                         error_size - cut, correction, scratch);
+  size_t drop = 2 * h - cut;
+  const uint32_t *delta = correction + std::min(drop, correction_size);
+  size_t delta_size = correction_size > drop ? correction_size - drop : 0;
+
+  std::fill(x, x + shift, 0);
+  std::copy(x_top, x_top + x_top_size, x + shift);
+  size_t x_size = shift + x_top_size;
+  if (negative) {
+    sub(x, x_size, delta, delta_size, x);
+    x_size = normalized_size(x, x_size);
+  } else if (delta_size > 0) {
+    size_t size = std::max(x_size, delta_size) + 1;
+    std::fill(x + x_size, x + size, 0);
+    add(x, size, delta, delta_size, x);
+    x_size = normalized_size(x, size);
+  }
+  return x_size;
+}
+
+} // namespace
+
+void divmod_knuth(const uint32_t *a, size_t a_size, const uint32_t *b,
+                  size_t b_size, uint32_t *quotient, uint32_t *remainder,
+                  Scratch &scratch) {
+  ScratchFrame frame(scratch);
+  size_t m = a_size, n = b_size;
+
+  // Normalize: top limb of the divisor gets at least BASE / 2, then the
+  // estimate of every quotient limb is at most 2 above the real one
+  uint32_t d = BASE / (b[n - 1] + 1);
+  uint32_t *u = scratch.alloc(m + 1);
+  uint32_t *v = scratch.alloc(n);
+  u[m] = mul_1(a, m, d, u);
+  mul_1(b, n, d, v);
+
+  for (size_t j = m - n + 1; j-- > 0;) {
+    uint64_t numerator = static_cast<uint64_t>(u[j + n]) * BASE + u[j + n - 1];
+    uint64_t q = numerator / v[n - 1];
+    uint64_t r = numerator % v[n - 1];
+    while (q >= BASE || q * v[n - 2] > r * BASE + u[j + n - 2]) {
+      --q;
+      r += v[n - 1];
+      if (r >= BASE) {
+        break;
+      }
+    }
+
+    // u[j..j+n] -= q * v
+    uint64_t carry = 0;
+    int64_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t product = q * v[i] + carry;
+      carry = product / BASE;
+      int64_t current = static_cast<int64_t>(u[i + j]) -
+                        static_cast<int64_t>(product % BASE) - borrow;
+      borrow = current < 0;
+      u[i + j] = current + (borrow ? BASE : 0);
+    }
+    int64_t top = static_cast<int64_t>(u[j + n]) -
+                  static_cast<int64_t>(carry) - borrow;
+
+    // The estimate was one too large: add the divisor back
+    if (top < 0) {
+      --q;
+      top += add_n(u + j, v, u + j, n);
+    }
+    u[j + n] = top;
+    quotient[j] = q;
+  }
+
+  div_1(u, n, d, remainder);
+}
+
+size_t reciprocal(const uint32_t *v, size_t n, uint32_t *x, Scratch &scratch) {
+  size_t x_size = ApproximateReciprocal(v, n, x, scratch);
+  if (n >= DIV_NEWTON_THRESHOLD) {
+    CorrectReciprocal(v, n, x, x_size, scratch);
+  }
+  return x_size;
+}
+
+void divmod_newton(const uint32_t *a, size_t a_size, const uint32_t *b,
+                   size_t b_size, uint32_t *quotient, uint32_t *remainder,
+                   Scratch &scratch) {
+  ScratchFrame frame(scratch);
+  size_t n = b_size;
+  uint32_t *x = scratch.alloc(n + 3);
+  size_t x_size = reciprocal(b, n, x, scratch);
+
+  // a is divided by blocks of n limbs from the top, like schoolbook
+  // division in base B^n: every block quotient is estimated as
+  // w * x / B^(2n) and is at most 2 below the real one while w < B^(2n)
+  uint32_t *q = scratch.alloc(a_size);
+  uint32_t *digit = scratch.alloc(n + 3);
+  uint32_t *w = scratch.alloc(2 * n + 1);
+  uint32_t *estimate = scratch.alloc(3 * n + 4);
+  uint32_t *qv = scratch.alloc(3 * n + 4);
+  uint32_t *rest = scratch.alloc(n);
+  size_t rest_size = 0;
+
+  // The top block takes from n to 2n - 1 limbs, it has no remainder above
+  size_t low = (a_size - n) / n * n;
+  size_t len = a_size - low;
+  while (true) {
+    std::copy(a + low, a + low + len, w);
+    std::copy(rest, rest + rest_size, w + len);
+    size_t w_size = normalized_size(w, len + rest_size);
+
+    size_t estimate_size =
+        MulNormalized(w, w_size, x, x_size, estimate, scratch);
+    const uint32_t *q_block = estimate + std::min(2 * n, estimate_size);
+    size_t q_block_size = estimate_size > 2 * n ? estimate_size - 2 * n : 0;
+    std::copy(q_block, q_block + q_block_size, digit);
+    size_t digit_size = q_block_size;
+
+    size_t qv_size = MulNormalized(digit, digit_size, b, n, qv, scratch);
+    sub(w, w_size, qv, qv_size, w);
+    w_size = normalized_size(w, w_size);
+
+    while (compare(w, w_size, b, n) >= 0) {
+      sub(w, w_size, b, n, w);
+      w_size = normalized_size(w, w_size);
+      Increment(digit, digit_size);
+    }
+    std::fill(q + low, q + low + len, 0);
+    std::copy(digit, digit + digit_size, q + low);
+
+    std::copy(w, w + w_size, rest);
+    rest_size = w_size;
+    if (low == 0) {
+      break;
+    }
+    low -= n;
+    len = n;
+  }
+
+  std::copy(q, q + a_size - n + 1, quotient);
+  std::fill(remainder, remainder + n, 0);
+  std::copy(rest, rest + rest_size, remainder);
+}
+
+void divmod(const uint32_t *a, size_t a_size, const uint32_t *b, size_t b_size,
+            uint32_t *quotient, uint32_t *remainder, Scratch &scratch) {
+  if (b_size == 1) {
+    remainder[0] = div_1(a, a_size, b[0], quotient);
+  } else if (b_size < DIV_NEWTON_THRESHOLD ||
+             a_size - b_size + 1 < DIV_NEWTON_THRESHOLD) {
+    divmod_knuth(a, a_size, b, b_size, quotient, remainder, scratch);
+  } else {
+    divmod_newton(a, a_size, b, b_size, quotient, remainder, scratch);
+  }
+}
+
+void divmod(const uint32_t *a, size_t a_size, const uint32_t *b, size_t b_size,
+            uint32_t *quotient, uint32_t *remainder) {
+  Scratch scratch(2 * a_size + 8 * b_size + 16);
+  divmod(a, a_size, b, b_size, quotient, remainder, scratch);
+}
+
+} // namespace limbs
+} // namespace bigint_huawei
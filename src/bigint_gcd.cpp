@@ -0,0 +1,409 @@
+#include "bigint.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace bigint_huawei {
+
+using namespace std::literals::string_literals;
+
+namespace {
+
+/**
+ * Size (in limbs) of the smaller number from which the half-GCD recursion is
+ * used instead of plain Lehmer steps. See bench/bench_bigint.cpp for the
+ * measurements.
+ */
+constexpr size_t HGCD_THRESHOLD = 100;
+
+/**
+ * Natural number as limbs without leading zero limbs, 0 has no limbs.
+ */
+using Natural = std::vector<uint32_t>;
+
+void Trim(Natural &a) { a.resize(limbs::normalized_size(a.data(), a.size())); }
+
+int Compare(const Natural &a, const Natural &b) {
+  return limbs::compare(a.data(), a.size(), b.data(), b.size());
+}
+
+Natural Mul(const Natural &a, const Natural &b) {
+  if (a.empty() || b.empty()) {
+    return {};
+  }
+  Natural result(a.size() + b.size());
+  limbs::mul(a.data(), a.size(), b.data(), b.size(), result.data());
+  Trim(result);
+  return result;
+}
+
+Natural Mul(const Natural &a, uint32_t factor) {
+  Natural result(a.size() + 1);
+  result.back() = limbs::mul_1(a.data(), a.size(), factor, result.data());
+  Trim(result);
+  return result;
+}
+
+/**
+ * a += b.
+ */
+void AddTo(Natural &a, const Natural &b) {
+  if (a.size() < b.size()) {
+    a.resize(b.size(), 0);
+  }
+  a.push_back(0);
+  a.back() = limbs::add(a.data(), a.size() - 1, b.data(), b.size(), a.data());
+  Trim(a);
+}
+
+/**
+ * a -= b, a must be not less than b.
+ */
+void SubFrom(Natural &a, const Natural &b) {
+  limbs::sub(a.data(), a.size(), b.data(), b.size(), a.data());
+  Trim(a);
+}
+
+/**
+ * Replaces a by a mod b and returns the quotient, b is not 0 and a >= b.
+ */
+Natural DivMod(Natural &a, const Natural &b) {
+  Natural quotient(a.size() - b.size() + 1), remainder(b.size());
+  limbs::divmod(a.data(), a.size(), b.data(), b.size(), quotient.data(),
+                remainder.data());
+  Trim(quotient);
+  Trim(remainder);
+  a = std::move(remainder);
+  return quotient;
+}
+
+/**
+ * Reduction matrix M = [[m00, m01], [m10, m11]] of a part of the remainder
+ * sequence: (a, b) = M * (a', b') where (a', b') are the reduced numbers.
+ * Entries are not negative and det M = 1, so gcd(a, b) = gcd(a', b') and
+ * (a', b') = (m11 * a - m01 * b, m00 * b - m10 * a).
+ */
+struct Matrix {
+  Natural m[2][2] = {{{1}, {}}, {{}, {1}}};
+
+  bool is_identity() const {
+    return m[0][1].empty() && m[1][0].empty();
+  }
+};
+
+Matrix Multiply(const Matrix &x, const Matrix &y) {
+  Matrix result;
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      result.m[i][j] = Mul(x.m[i][0], y.m[0][j]);
+      AddTo(result.m[i][j], Mul(x.m[i][1], y.m[1][j]));
+    }
+  }
+  return result;
+}
+
+/**
+ * (a, b) = M^(-1) * (a, b), returns false and keeps the numbers if any of the
+ * results is negative (the matrix was built from approximations and does not
+ * fit these numbers).
+ */
+bool ApplyInverse(const Matrix &matrix, Natural &a, Natural &b) {
+  Natural a_plus = Mul(matrix.m[1][1], a), a_minus = Mul(matrix.m[0][1], b);
+  Natural b_plus = Mul(matrix.m[0][0], b), b_minus = Mul(matrix.m[1][0], a);
+  if (Compare(a_plus, a_minus) < 0 || Compare(b_plus, b_minus) < 0) {
+    return false;
+  }
+  SubFrom(a_plus, a_minus);
+  SubFrom(b_plus, b_minus);
+  a = std::move(a_plus);
+  b = std::move(b_plus);
+  return true;
+}
+
+/**
+ * One exact Euclid step: the larger number is replaced by the remainder,
+ * the matrix (if any) takes the quotient. With s > 0 the step is done only
+ * if the remainder keeps more than s limbs.
+ */
+bool DivStep(Natural &a, Natural &b, Matrix *matrix, size_t s) {
+  bool a_larger = Compare(a, b) >= 0;
+  Natural &larger = a_larger ? a : b;
+  const Natural &smaller = a_larger ? b : a;
+  Natural remainder = larger;
+  Natural quotient = DivMod(remainder, smaller);
+  if (s > 0 && remainder.size() <= s) {
+    return false;
+  }
+  larger = std::move(remainder);
+  if (matrix) {
+    // a -= q * b adds q * column 0 to column 1, b -= q * a is symmetric
+    int to = a_larger ? 1 : 0;
+    AddTo(matrix->m[0][to], Mul(quotient, matrix->m[0][1 - to]));
+    AddTo(matrix->m[1][to], Mul(quotient, matrix->m[1][1 - to]));
+  }
+  return true;
+}
+
+/**
+ * Lehmer step: Euclid runs on the top two limbs of both numbers (at the same
+ * position) in uint64, the quotients are collected into a matrix with limb
+ * entries that is applied to the whole numbers at once. Every accepted step
+ * keeps x - n01 and y - n10 (the approximations and the matrix entries) at
+ * least t, so the exact results are not negative and keep more than s limbs
+ * (at least 1 with s = 0).
+ *
+ * Time complexity: O(n + size of the matrix)
+ * @return false if no quotient could be taken
+ */
+bool LehmerStep(Natural &a, Natural &b, Matrix *matrix, size_t s) {
+  size_t n = std::max(a.size(), b.size());
+  if (n < 2 || s >= n) {
+    return false;
+  }
+  size_t shift = n - 2;
+  auto top = [&](const Natural &number) {
+    uint64_t high = number.size() > shift + 1 ? number[shift + 1] : 0;
+    uint64_t low = number.size() > shift ? number[shift] : 0;
+    return high * limbs::BASE + low;
+  };
+  uint64_t t = s > shift ? limbs::BASE : 1;
+  if (s > shift + 1) {
+    return false;
+  }
+
+  uint64_t x = top(a), y = top(b);
+  uint64_t n00 = 1, n01 = 0, n10 = 0, n11 = 1;
+  if (x < t || y < t) {
+    return false;
+  }
+  while (true) {
+    if (x >= y) {
+      uint64_t q = x / y;
+      if (q >= limbs::BASE) {
+        break;
+      }
+      uint64_t x_next = x - q * y;
+      uint64_t n01_next = n01 + q * n00, n11_next = n11 + q * n10;
+      if (n01_next >= limbs::BASE || n11_next >= limbs::BASE ||
+          x_next < n01_next + t) {
+        break;
+      }
+      x = x_next, n01 = n01_next, n11 = n11_next;
+    } else {
+      uint64_t q = y / x;
+      if (q >= limbs::BASE) {
+        break;
+      }
+      uint64_t y_next = y - q * x;
+      uint64_t n00_next = n00 + q * n01, n10_next = n10 + q * n11;
+      if (n00_next >= limbs::BASE || n10_next >= limbs::BASE ||
+          y_next < n10_next + t) {
+        break;
+      }
+      y = y_next, n00 = n00_next, n10 = n10_next;
+    }
+  }
+  if (n01 == 0 && n10 == 0) {
+    return false;
+  }
+
+  Natural a_next = Mul(a, n11), b_next = Mul(b, n00);
+  SubFrom(a_next, Mul(b, n01));
+  SubFrom(b_next, Mul(a, n10));
+  a = std::move(a_next);
+  b = std::move(b_next);
+  if (matrix) {
+    // M = M * N column by column
+    for (int i = 0; i < 2; ++i) {
+      Natural column0 = Mul(matrix->m[i][0], n00);
+      AddTo(column0, Mul(matrix->m[i][1], n10));
+      Natural column1 = Mul(matrix->m[i][0], n01);
+      AddTo(column1, Mul(matrix->m[i][1], n11));
+      matrix->m[i][0] = std::move(column0);
+      matrix->m[i][1] = std::move(column1);
+    }
+  }
+  return true;
+}
+
+/**
+ * Number without the lowest k limbs.
+ */
+Natural High(const Natural &a, size_t k) {
+  return a.size() > k ? Natural(a.begin() + k, a.end()) : Natural();
+}
+
+/**
+ * Half-GCD: reduces numbers of n limbs while both keep more than
+ * s = n / 2 + 1 limbs, the matrix collects the steps (it must be identity on
+ * the call).
+ *
+ * Reduction of the top halves is a valid reduction of the whole numbers
+ * too, so the top n / 2 limbs are reduced recursively, the matrix is applied
+ * to the whole numbers by fast multiplication and the top of the rest is
+ * reduced recursively once more. A few Lehmer or division steps finish.
+ *
+ * Time complexity: O(M(n) log n), M is the cost of multiplication
+ */
+void HalfGcd(Natural &a, Natural &b, Matrix &matrix) {
+  size_t n = std::max(a.size(), b.size());
+  size_t s = n / 2 + 1;
+  if (std::min(a.size(), b.size()) <= s) {
+    return;
+  }
+
+  if (n >= HGCD_THRESHOLD) {
+    size_t k = n / 2;
+    Natural a_high = High(a, k), b_high = High(b, k);
+    Matrix first;
+    HalfGcd(a_high, b_high, first);
+    if (!first.is_identity() && ApplyInverse(first, a, b)) {
+      matrix = std::move(first);
+    }
+
+    // The top 2 (n_rest - s) limbs are reduced to about s limbs in total.
+    // Numbers with a long common divisor may stop the first reduction early,
+    // then the top would not be shorter than the numbers and is skipped
+    size_t n_rest = std::max(a.size(), b.size());
+    if (std::min(a.size(), b.size()) > s && n_rest - s <= 3 * n / 8) {
+      size_t k_rest = 2 * s - n_rest;
+      a_high = High(a, k_rest);
+      b_high = High(b, k_rest);
+      Matrix second;
+      HalfGcd(a_high, b_high, second);
+      if (!second.is_identity() && ApplyInverse(second, a, b)) {
+        matrix = Multiply(matrix, second);
+      }
+    }
+  }
+
+  while (LehmerStep(a, b, &matrix, s) || DivStep(a, b, &matrix, s)) {
+  }
+}
+
+/**
+ * Reduces (a, b) to the gcd and 0, the matrix (if any) collects all the
+ * steps.
+ */
+void Reduce(Natural &a, Natural &b, Matrix *total) {
+  while (!a.empty() && !b.empty()) {
+    size_t larger = std::max(a.size(), b.size());
+    size_t smaller = std::min(a.size(), b.size());
+    if (smaller >= HGCD_THRESHOLD && larger - smaller <= smaller / 4) {
+      Matrix matrix;
+      HalfGcd(a, b, matrix);
+      if (!matrix.is_identity()) {
+        if (total) {
+          *total = Multiply(*total, matrix);
+        }
+        continue;
+      }
+    }
+    // Lehmer is useless when the numbers are of a different size
+    if (larger - smaller > 1 || !LehmerStep(a, b, total, 0)) {
+      DivStep(a, b, total, 0);
+    }
+  }
+}
+
+} // namespace
+
+/**
+ * Greatest common divisor, gcd(0, 0) = 0.
+ *
+ * Numbers of about the same size are reduced by half-GCD from HGCD_THRESHOLD
+ * limbs, then by Lehmer steps that take about one limb of the quotient
+ * sequence per pass over the numbers, different sizes are first aligned by
+ * the remainder.
+ *
+ * Time complexity: O(M(n) log n) where n is a number of limbs, O(n^2) below
+ * HGCD_THRESHOLD limbs
+ * Space complexity: O(n) where n is a number of limbs
+ */
+BigInt gcd(const BigInt &first, const BigInt &second) {
+  uint32_t first_buffer[limbs::SMALL_LIMBS], second_buffer[limbs::SMALL_LIMBS];
+  size_t first_size, second_size;
+  const uint32_t *first_data = first.limb_data(first_buffer, first_size);
+  const uint32_t *second_data = second.limb_data(second_buffer, second_size);
+  Natural a(first_data, first_data + first_size);
+  Natural b(second_data, second_data + second_size);
+  Reduce(a, b, nullptr);
+
+  BigInt result;
+  const Natural &divisor = a.empty() ? b : a;
+  result.limbs.assign(divisor.begin(), divisor.end());
+  result.normalize();
+  return result;
+}
+
+/**
+ * Least common multiple, lcm(0, n) = 0.
+ *
+ * Time complexity: O(M(n) log n) where n is a number of limbs
+ * Space complexity: O(n) where n is a number of limbs
+ */
+BigInt lcm(const BigInt &first, const BigInt &second) {
+  if (first == BigInt() || second == BigInt()) {
+    return BigInt();
+  }
+  return first / gcd(first, second) * second;
+}
+
+/**
+ * Modular inverse x of the number: number * x = 1 (mod modulus), x is less
+ * than the modulus.
+ *
+ * Runs the reduction of gcd(modulus, number mod modulus) that collects the
+ * total matrix, its column gives the cofactor of the number.
+ *
+ * Time complexity: O(M(n) log n) where n is a number of limbs
+ * Space complexity: O(n) where n is a number of limbs
+ *
+ * @throws std::invalid_argument if the modulus is 0 or the number is not
+ * coprime with the modulus
+ */
+BigInt modinv(const BigInt &number, const BigInt &modulus) {
+  if (modulus == BigInt()) {
+    throw std::invalid_argument("Modulus must be positive"s);
+  }
+  if (modulus == BigInt(1)) {
+    return BigInt();
+  }
+  BigInt reduced = number % modulus;
+  uint32_t buffer[limbs::SMALL_LIMBS];
+  size_t size;
+  const uint32_t *data = modulus.limb_data(buffer, size);
+  Natural m(data, data + size);
+  data = reduced.limb_data(buffer, size);
+  Natural a(data, data + size);
+
+  // (m, a) = T * (x, y): x = -t01 * a (mod m) and y = t00 * a (mod m)
+  Natural x = m, y = a;
+  Matrix total;
+  Reduce(x, y, &total);
+  const Natural &divisor = x.empty() ? y : x;
+  if (divisor != Natural{1}) {
+    throw std::invalid_argument("Number is not invertible modulo "s +
+                                modulus.to_string());
+  }
+
+  Natural cofactor = x.empty() ? total.m[0][0] : total.m[0][1];
+  if (Compare(cofactor, m) >= 0) {
+    DivMod(cofactor, m);
+  }
+  if (!x.empty() && !cofactor.empty()) {
+    // -t01 mod m
+    Natural negated = m;
+    SubFrom(negated, cofactor);
+    cofactor = std::move(negated);
+  }
+
+  BigInt result;
+  result.limbs.assign(cofactor.begin(), cofactor.end());
+  result.normalize();
+  return result;
+}
+
+} // namespace bigint_huawei
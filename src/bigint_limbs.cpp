@@ -0,0 +1,579 @@
+#include "bigint_limbs.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "cpu_features.h"
+
+namespace bigint_huawei {
+namespace limbs {
+
+size_t from_uint128(uint128 number, uint32_t *result) {
+  size_t n = 0;
+  // 64-bit division is much cheaper, use it as soon as the number fits
+  while (number >> 64) {
+    result[n++] = number % BASE;
+    number /= BASE;
+  }
+  uint64_t rest = number;
+  while (rest != 0) {
+    result[n++] = rest % BASE;
+    rest /= BASE;
+  }
+  return n;
+}
+
+uint128 to_uint128(const uint32_t *a, size_t n) {
+  uint128 number = 0;
+  for (size_t i = n; i > 0; --i) {
+    number = number * BASE + a[i - 1];
+  }
+  return number;
+}
+
+uint32_t add_n_scalar(const uint32_t *a, const uint32_t *b, uint32_t *result,
+                      size_t n, uint32_t carry) {
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t sum = a[i] + b[i] + carry;
+    carry = sum >= BASE;
+    result[i] = sum - (carry ? BASE : 0);
+  }
+  return carry;
+}
+
+/**
+ * Resolves carries of a block of lanes.
+ *
+ * Generate lanes are the ones where both "operands" of a binary addition are
+ * 1 and propagate lanes are the ones where only one of them is 1, so
+ * (G | P) + G + carry produces the carry into every lane in one step.
+ *
+ * @param generate - bitmask of lanes with sum >= BASE
+ * @param propagate - bitmask of lanes with sum == BASE - 1
+ * @param lanes - number of lanes in the block
+ * @param carry - carry into the block, updated with carry out of it
+ * @return bitmask of lanes that receive a carry
+ */
+static inline unsigned LookaheadCarries(unsigned generate, unsigned propagate,
+                                        unsigned lanes, uint32_t &carry) {
+  unsigned either = generate | propagate;
+  unsigned total = either + generate + carry;
+  carry = total >> lanes;
+  return (total ^ either ^ generate) & ((1u << lanes) - 1);
+}
+
+#if defined(__x86_64__)
+
+// SSE2 is a part of x86-64, AVX2 and AVX-512 variants are compiled for their
+// targets and are called only when the CPU supports them (see cpu_features.h)
+
+static uint32_t AddNSse2(const uint32_t *a, const uint32_t *b,
+                         uint32_t *result, size_t n, uint32_t carry) {
+  // Sum of two limbs is below 2 * BASE < 2^31, signed compares are fine
+  const __m128i base_minus_one = _mm_set1_epi32(BASE - 1);
+  const __m128i base = _mm_set1_epi32(BASE);
+  const __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i sum = _mm_add_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+    unsigned generate = _mm_movemask_ps(
+        _mm_castsi128_ps(_mm_cmpgt_epi32(sum, base_minus_one)));
+    unsigned propagate = _mm_movemask_ps(
+        _mm_castsi128_ps(_mm_cmpeq_epi32(sum, base_minus_one)));
+    unsigned carries = LookaheadCarries(generate, propagate, 4, carry);
+
+    // Lanes with carry become -1, subtracting them adds the carry
+    __m128i lane_carries = _mm_cmpeq_epi32(
+        _mm_and_si128(_mm_set1_epi32(carries), lane_bits), lane_bits);
+    sum = _mm_sub_epi32(sum, lane_carries);
+    __m128i overflow = _mm_cmpgt_epi32(sum, base_minus_one);
+    sum = _mm_sub_epi32(sum, _mm_and_si128(overflow, base));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(result + i), sum);
+  }
+  return add_n_scalar(a + i, b + i, result + i, n - i, carry);
+}
+
+__attribute__((target("avx2"))) static uint32_t
+AddNAvx2(const uint32_t *a, const uint32_t *b, uint32_t *result, size_t n,
+         uint32_t carry) {
+  const __m256i base_minus_one = _mm256_set1_epi32(BASE - 1);
+  const __m256i base = _mm256_set1_epi32(BASE);
+  const __m256i lane_shifts = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i one = _mm256_set1_epi32(1);
+
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i sum = _mm256_add_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+    unsigned generate = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpgt_epi32(sum, base_minus_one)));
+    unsigned propagate = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(sum, base_minus_one)));
+    unsigned carries = LookaheadCarries(generate, propagate, 8, carry);
+
+    __m256i lane_carries = _mm256_and_si256(
+        _mm256_srlv_epi32(_mm256_set1_epi32(carries), lane_shifts), one);
+    sum = _mm256_add_epi32(sum, lane_carries);
+    __m256i overflow = _mm256_cmpgt_epi32(sum, base_minus_one);
+    sum = _mm256_sub_epi32(sum, _mm256_and_si256(overflow, base));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), sum);
+  }
+  return add_n_scalar(a + i, b + i, result + i, n - i, carry);
+}
+
+__attribute__((target("avx512f"))) static uint32_t
+AddNAvx512(const uint32_t *a, const uint32_t *b, uint32_t *result, size_t n,
+           uint32_t carry) {
+  // Compares give lane bitmasks directly, carries are added under a mask
+  const __m512i base_minus_one = _mm512_set1_epi32(BASE - 1);
+  const __m512i base = _mm512_set1_epi32(BASE);
+  const __m512i one = _mm512_set1_epi32(1);
+
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i sum = _mm512_add_epi32(_mm512_loadu_si512(a + i),
+                                   _mm512_loadu_si512(b + i));
+    unsigned generate = _mm512_cmpgt_epi32_mask(sum, base_minus_one);
+    unsigned propagate = _mm512_cmpeq_epi32_mask(sum, base_minus_one);
+    unsigned carries = LookaheadCarries(generate, propagate, 16, carry);
+
+    sum = _mm512_mask_add_epi32(sum, carries, sum, one);
+    __mmask16 overflow = _mm512_cmpgt_epi32_mask(sum, base_minus_one);
+    sum = _mm512_mask_sub_epi32(sum, overflow, sum, base);
+    _mm512_storeu_si512(result + i, sum);
+  }
+  return add_n_scalar(a + i, b + i, result + i, n - i, carry);
+}
+
+#endif
+
+typedef uint32_t (*AddNKernel)(const uint32_t *, const uint32_t *, uint32_t *,
+                               size_t, uint32_t);
+
+uint32_t add_n(const uint32_t *a, const uint32_t *b, uint32_t *result,
+               size_t n, uint32_t carry) {
+#if defined(__x86_64__)
+  static constexpr AddNKernel KERNELS[cpu_huawei::SIMD_LEVELS] = {
+      add_n_scalar, AddNSse2, AddNAvx2, AddNAvx512};
+  return KERNELS[static_cast<int>(cpu_huawei::simd_level())](a, b, result, n,
+                                                              carry);
+#else
+  return add_n_scalar(a, b, result, n, carry);
+#endif
+}
+
+static void AddWideScalar(uint64_t *sum, const uint32_t *a, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    sum[i] += a[i];
+  }
+}
+
+#if defined(__x86_64__)
+
+static void AddWideSse2(uint64_t *sum, const uint32_t *a, size_t n) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i limbs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i *target = reinterpret_cast<__m128i *>(sum + i);
+    _mm_storeu_si128(target, _mm_add_epi64(_mm_loadu_si128(target),
+                                           _mm_unpacklo_epi32(limbs, zero)));
+    _mm_storeu_si128(target + 1,
+                     _mm_add_epi64(_mm_loadu_si128(target + 1),
+                                   _mm_unpackhi_epi32(limbs, zero)));
+  }
+  AddWideScalar(sum + i, a + i, n - i);
+}
+
+__attribute__((target("avx2"))) static void
+AddWideAvx2(uint64_t *sum, const uint32_t *a, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i wide = _mm256_cvtepu32_epi64(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)));
+    __m256i *target = reinterpret_cast<__m256i *>(sum + i);
+    _mm256_storeu_si256(target,
+                        _mm256_add_epi64(_mm256_loadu_si256(target), wide));
+  }
+  AddWideScalar(sum + i, a + i, n - i);
+}
+
+__attribute__((target("avx512f"))) static void
+AddWideAvx512(uint64_t *sum, const uint32_t *a, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    // The masked form, the plain one trips -Wmaybe-uninitialized in GCC 12
+    __m512i wide = _mm512_maskz_cvtepu32_epi64(
+        0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)));
+    _mm512_storeu_si512(sum + i,
+                        _mm512_add_epi64(_mm512_loadu_si512(sum + i), wide));
+  }
+  AddWideScalar(sum + i, a + i, n - i);
+}
+
+#endif
+
+typedef void (*AddWideKernel)(uint64_t *, const uint32_t *, size_t);
+
+void add_wide(uint64_t *sum, const uint32_t *a, size_t n) {
+#if defined(__x86_64__)
+  static constexpr AddWideKernel KERNELS[cpu_huawei::SIMD_LEVELS] = {
+      AddWideScalar, AddWideSse2, AddWideAvx2, AddWideAvx512};
+  KERNELS[static_cast<int>(cpu_huawei::simd_level())](sum, a, n);
+#else
+  AddWideScalar(sum, a, n);
+#endif
+}
+
+uint32_t add_carry(const uint32_t *a, uint32_t *result, size_t n,
+                   uint32_t carry) {
+  size_t i = 0;
+  if (carry) {
+    while (i < n && a[i] == BASE - 1) {
+      result[i++] = 0;
+    }
+    if (i == n) {
+      return 1;
+    }
+    result[i] = a[i] + 1;
+    ++i;
+  }
+  if (a != result && i < n) {
+    std::memcpy(result + i, a + i, (n - i) * sizeof(uint32_t));
+  }
+  return 0;
+}
+
+uint32_t add_n_parallel(const uint32_t *a, const uint32_t *b, uint32_t *result,
+                        size_t n, uint32_t carry,
+                        thread_pool_huawei::ThreadPool &pool,
+                        size_t min_block) {
+  size_t blocks = std::min(4 * (pool.size() + 1), n / min_block);
+  if (blocks < 2) {
+    return add_n(a, b, result, n, carry);
+  }
+  size_t block_size = (n + blocks - 1) / blocks;
+  blocks = (n + block_size - 1) / block_size;
+
+  std::vector<uint8_t> carries(blocks), propagates(blocks);
+  pool.parallel_for(blocks, [&](size_t block) {
+    size_t begin = block * block_size;
+    size_t size = std::min(block_size, n - begin);
+    carries[block] = add_n(a + begin, b + begin, result + begin, size);
+    propagates[block] =
+        std::all_of(result + begin, result + begin + size,
+                    [](uint32_t limb) { return limb == BASE - 1; });
+  });
+
+  // Incoming carry of every block, a block passes the carry through only
+  // when all its limbs are BASE - 1
+  std::vector<uint8_t> incoming(blocks);
+  for (size_t block = 0; block < blocks; ++block) {
+    incoming[block] = carry;
+    carry = carries[block] | (propagates[block] & carry);
+  }
+
+  pool.parallel_for(blocks, [&](size_t block) {
+    if (incoming[block]) {
+      size_t begin = block * block_size;
+      size_t size = std::min(block_size, n - begin);
+      add_carry(result + begin, result + begin, size, 1);
+    }
+  });
+  return carry;
+}
+
+uint32_t add(const uint32_t *a, size_t a_size, const uint32_t *b,
+             size_t b_size, uint32_t *result) {
+  thread_pool_huawei::ThreadPool *pool = nullptr;
+  if (b_size >= PARALLEL_ADD_THRESHOLD) {
+    pool = &thread_pool_huawei::ThreadPool::shared();
+  }
+  uint32_t carry = pool != nullptr && pool->size() > 1
+                       ? add_n_parallel(a, b, result, b_size, 0, *pool)
+                       : add_n(a, b, result, b_size);
+  return add_carry(a + b_size, result + b_size, a_size - b_size, carry);
+}
+
+uint32_t sub_n(const uint32_t *a, const uint32_t *b, uint32_t *result,
+               size_t n, uint32_t borrow) {
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t subtrahend = b[i] + borrow;
+    borrow = a[i] < subtrahend;
+    result[i] = a[i] - subtrahend + (borrow ? BASE : 0);
+  }
+  return borrow;
+}
+
+uint32_t sub(const uint32_t *a, size_t a_size, const uint32_t *b,
+             size_t b_size, uint32_t *result) {
+  uint32_t borrow = sub_n(a, b, result, b_size);
+  size_t i = b_size;
+  if (borrow) {
+    while (i < a_size && a[i] == 0) {
+      result[i++] = BASE - 1;
+    }
+    if (i == a_size) {
+      return 1;
+    }
+    result[i] = a[i] - 1;
+    ++i;
+  }
+  if (a != result && i < a_size) {
+    std::memcpy(result + i, a + i, (a_size - i) * sizeof(uint32_t));
+  }
+  return 0;
+}
+
+int compare(const uint32_t *a, size_t a_size, const uint32_t *b,
+            size_t b_size) {
+  if (a_size != b_size) {
+    return a_size < b_size ? -1 : 1;
+  }
+  for (size_t i = a_size; i > 0; --i) {
+    if (a[i - 1] != b[i - 1]) {
+      return a[i - 1] < b[i - 1] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+size_t normalized_size(const uint32_t *a, size_t n) {
+  while (n > 0 && a[n - 1] == 0) {
+    --n;
+  }
+  return n;
+}
+
+uint32_t mul_1(const uint32_t *a, size_t n, uint32_t multiplier,
+               uint32_t *result) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t product = static_cast<uint64_t>(a[i]) * multiplier + carry;
+    result[i] = product % BASE;
+    carry = product / BASE;
+  }
+  return carry;
+}
+
+uint32_t div_1(const uint32_t *a, size_t n, uint32_t divisor,
+               uint32_t *result) {
+  uint64_t remainder = 0;
+  for (size_t i = n; i > 0; --i) {
+    uint64_t current = remainder * BASE + a[i - 1];
+    result[i - 1] = current / divisor;
+    remainder = current % divisor;
+  }
+  return remainder;
+}
+
+Scratch::Scratch(size_t initial_size) {
+  if (initial_size > 0) {
+    blocks.push_back(
+        {std::unique_ptr<uint32_t[]>(new uint32_t[initial_size]), initial_size});
+  }
+}
+
+uint32_t *Scratch::alloc(size_t n) {
+  while (block < blocks.size() && blocks[block].size - offset < n) {
+    ++block;
+    offset = 0;
+  }
+  if (block == blocks.size()) {
+    size_t size = std::max(n, blocks.empty() ? 1024 : 2 * blocks.back().size);
+    blocks.push_back({std::unique_ptr<uint32_t[]>(new uint32_t[size]), size});
+  }
+  uint32_t *buffer = blocks[block].data.get() + offset;
+  offset += n;
+  return buffer;
+}
+
+/**
+ * Loads 8 characters as a little endian word, the first character goes to
+ * the lowest byte.
+ */
+static inline uint64_t LoadEightChars(const char *chars) {
+  uint64_t word;
+  std::memcpy(&word, chars, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+/**
+ * Checks that all 8 bytes are in '0'..'9' range: high nibble must be 3 and
+ * adding 6 must not carry into it.
+ */
+static inline bool IsEightDigits(uint64_t word) {
+  return ((word & 0xF0F0F0F0F0F0F0F0) |
+          (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+         0x3333333333333333;
+}
+
+/**
+ * Converts 8 digit characters into a number: pairs of digits are combined
+ * first, then pairs of pairs and so on, 3 multiplications in total.
+ */
+static inline uint32_t ParseEightDigits(uint64_t word) {
+  word -= 0x3030303030303030;
+  word = (word * 10) + (word >> 8);
+  word = (((word & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+          (((word >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >>
+         32;
+  return static_cast<uint32_t>(word);
+}
+
+static bool ParseDecimalScalar(const char *digits, size_t n,
+                               uint32_t *result) {
+  bool valid = true;
+  size_t k = 0;
+  size_t end = n;
+  for (; end >= 9; end -= 9) {
+    const char *chunk = digits + end - 9;
+    uint64_t word = LoadEightChars(chunk + 1);
+    uint32_t first = static_cast<uint32_t>(chunk[0] - '0');
+    valid &= IsEightDigits(word) & (first <= 9);
+    result[k++] = first * 100000000 + ParseEightDigits(word);
+  }
+
+  if (end > 0) {
+    uint32_t limb = 0;
+    for (size_t i = 0; i < end; ++i) {
+      uint32_t digit = static_cast<uint32_t>(digits[i] - '0');
+      valid &= digit <= 9;
+      limb = limb * 10 + digit;
+    }
+    result[k] = limb;
+  }
+  return valid;
+}
+
+#if defined(__x86_64__)
+
+/**
+ * Parses 4 full limbs per step: the 8 digit parts of the limbs go to the
+ * lanes of one vector, pairs of digits and then pairs of pairs are combined
+ * by multiply-add instructions, the leading digits are added in 64-bit
+ * lanes. The rest is parsed by the scalar kernel.
+ */
+__attribute__((target("avx2"))) static bool
+ParseDecimalAvx2(const char *digits, size_t n, uint32_t *result) {
+  const __m256i zero_chars = _mm256_set1_epi8('0');
+  const __m256i nine = _mm256_set1_epi8(9);
+  const __m256i zero_char = _mm256_set1_epi64x('0');
+  const __m256i nine_wide = _mm256_set1_epi64x(9);
+  const __m256i zero = _mm256_setzero_si256();
+  // Weights of the lower and the higher byte (word) of every pair
+  const __m256i pair_weights = _mm256_set1_epi16(0x010A);
+  const __m256i quad_weights = _mm256_set1_epi32(0x00010064);
+  const __m256i ten_thousand = _mm256_set1_epi64x(10000);
+  const __m256i hundred_million = _mm256_set1_epi64x(100000000);
+  const __m256i limb_lanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+  __m256i invalid = zero;
+  size_t k = 0;
+  size_t end = n;
+  for (; end >= 36; end -= 36, k += 4) {
+    // The lowest limb is the last 9 digits
+    const char *chunk = digits + end - 36;
+    // Leading digits stay in registers, a round trip through memory stalls
+    // on store forwarding
+    __m256i first = _mm256_sub_epi64(
+        _mm256_setr_epi64x(static_cast<unsigned char>(chunk[27]),
+                           static_cast<unsigned char>(chunk[18]),
+                           static_cast<unsigned char>(chunk[9]),
+                           static_cast<unsigned char>(chunk[0])),
+        zero_char);
+    invalid = _mm256_or_si256(
+        invalid, _mm256_or_si256(_mm256_cmpgt_epi64(first, nine_wide),
+                                 _mm256_cmpgt_epi64(zero, first)));
+
+    __m256i words = _mm256_sub_epi8(
+        _mm256_setr_epi64x(LoadEightChars(chunk + 28),
+                           LoadEightChars(chunk + 19),
+                           LoadEightChars(chunk + 10),
+                           LoadEightChars(chunk + 1)),
+        zero_chars);
+    invalid = _mm256_or_si256(
+        invalid, _mm256_or_si256(_mm256_cmpgt_epi8(words, nine),
+                                 _mm256_cmpgt_epi8(zero, words)));
+
+    __m256i pairs = _mm256_maddubs_epi16(words, pair_weights);
+    __m256i quads = _mm256_madd_epi16(pairs, quad_weights);
+    __m256i limbs = _mm256_add_epi64(_mm256_mul_epu32(quads, ten_thousand),
+                                     _mm256_srli_epi64(quads, 32));
+    limbs = _mm256_add_epi64(limbs, _mm256_mul_epu32(first, hundred_million));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(result + k),
+                     _mm256_castsi256_si128(
+                         _mm256_permutevar8x32_epi32(limbs, limb_lanes)));
+  }
+  bool valid = _mm256_testz_si256(invalid, invalid) != 0;
+  return ParseDecimalScalar(digits, end, result + k) & valid;
+}
+
+#endif
+
+typedef bool (*ParseDecimalKernel)(const char *, size_t, uint32_t *);
+
+bool parse_decimal(const char *digits, size_t n, uint32_t *result) {
+#if defined(__x86_64__)
+  // SSE2 has no multiply-add of bytes, AVX-512 adds nothing over AVX2 here
+  static constexpr ParseDecimalKernel KERNELS[cpu_huawei::SIMD_LEVELS] = {
+      ParseDecimalScalar, ParseDecimalScalar, ParseDecimalAvx2,
+      ParseDecimalAvx2};
+  return KERNELS[static_cast<int>(cpu_huawei::simd_level())](digits, n,
+                                                              result);
+#else
+  return ParseDecimalScalar(digits, n, result);
+#endif
+}
+
+static const char DIGIT_PAIRS[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
+
+/**
+ * Writes number below 10^4 as exactly 4 digits.
+ */
+static inline char *FormatFourDigits(uint32_t number, char *out) {
+  std::memcpy(out, DIGIT_PAIRS + 2 * (number / 100), 2);
+  std::memcpy(out + 2, DIGIT_PAIRS + 2 * (number % 100), 2);
+  return out + 4;
+}
+
+char *format_limb(uint32_t limb, char *out) {
+  *out++ = '0' + limb / 100000000;
+  limb %= 100000000;
+  out = FormatFourDigits(limb / 10000, out);
+  return FormatFourDigits(limb % 10000, out);
+}
+
+char *format_top_limb(uint32_t limb, char *out) {
+  char buffer[9];
+  format_limb(limb, buffer);
+  size_t skip = 0;
+  while (skip < 8 && buffer[skip] == '0') {
+    ++skip;
+  }
+  std::memcpy(out, buffer + skip, 9 - skip);
+  return out + 9 - skip;
+}
+
+} // namespace limbs
+} // namespace bigint_huawei
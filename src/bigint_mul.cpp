@@ -0,0 +1,257 @@
+#include "bigint_limbs.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bigint_huawei {
+namespace limbs {
+
+namespace {
+
+/**
+ * Signed number used by Toom-3 evaluation and interpolation.
+ * Data has no leading zero limbs.
+ */
+struct Signed {
+  uint32_t *data;
+  size_t size;
+  bool negative;
+};
+
+Signed MakeSigned(uint32_t *data, size_t size, bool negative = false) {
+  size = normalized_size(data, size);
+  return {data, size, negative && size > 0};
+}
+
+/**
+ * result = x + y (or x - y when subtract is set), result must have room for
+ * max(x.size, y.size) + 1 limbs and may alias x or y.
+ */
+Signed AddSigned(const Signed &x, const Signed &y, uint32_t *result,
+                 bool subtract = false) {
+  bool y_negative = y.negative != subtract && y.size > 0;
+  if (x.negative == y_negative) {
+    const Signed &longer = x.size >= y.size ? x : y;
+    const Signed &shorter = x.size >= y.size ? y : x;
+    uint32_t carry = add(longer.data, longer.size, shorter.data, shorter.size,
+                         result);
+    result[longer.size] = carry;
+    return MakeSigned(result, longer.size + 1, x.negative);
+  }
+
+  if (compare(x.data, x.size, y.data, y.size) >= 0) {
+    sub(x.data, x.size, y.data, y.size, result);
+    return MakeSigned(result, x.size, x.negative);
+  }
+  sub(y.data, y.size, x.data, x.size, result);
+  return MakeSigned(result, y.size, y_negative);
+}
+
+/**
+ * Exact division of the magnitude by a small number, in place.
+ */
+Signed DivideExact(const Signed &x, uint32_t divisor) {
+  div_1(x.data, x.size, divisor, x.data);
+  return MakeSigned(x.data, x.size, x.negative);
+}
+
+/**
+ * Multiplies two signed numbers, result has room for x.size + y.size limbs.
+ */
+Signed MulSigned(const Signed &x, const Signed &y, uint32_t *result,
+                 Scratch &scratch) {
+  mul(x.data, x.size, y.data, y.size, result, scratch);
+  return MakeSigned(result, x.size + y.size, x.negative != y.negative);
+}
+
+/**
+ * Evaluates m0 + m1 * x + m2 * x^2 at 1, -1 and -2.
+ * Each output buffer has room for part_size + 2 limbs.
+ */
+void EvaluateToom3(const uint32_t *m, size_t size, size_t part_size,
+                   uint32_t *at_one, uint32_t *at_minus_one,
+                   uint32_t *at_minus_two, Signed &p1, Signed &pm1,
+                   Signed &pm2) {
+  auto part = [&](size_t i) {
+    size_t begin = std::min(size, i * part_size);
+    size_t end = i == 2 ? size : std::min(size, (i + 1) * part_size);
+    return MakeSigned(const_cast<uint32_t *>(m) + begin, end - begin);
+  };
+  Signed m0 = part(0), m1 = part(1), m2 = part(2);
+
+  // at_minus_two keeps m0 + m2 for a moment
+  Signed even = AddSigned(m0, m2, at_minus_two);
+  p1 = AddSigned(even, m1, at_one);
+  pm1 = AddSigned(even, m1, at_minus_one, true);
+  pm2 = AddSigned(pm1, m2, at_minus_two);
+  pm2 = AddSigned(pm2, pm2, at_minus_two);
+  pm2 = AddSigned(pm2, m0, at_minus_two, true);
+}
+
+/**
+ * Adds value into result at the given limb offset.
+ */
+void AddAt(uint32_t *result, size_t result_size, size_t offset,
+           const Signed &value) {
+  if (value.size > 0) {
+    add(result + offset, result_size - offset, value.data, value.size,
+        result + offset);
+  }
+}
+
+void MulUnbalanced(const uint32_t *a, size_t a_size, const uint32_t *b,
+                   size_t b_size, uint32_t *result, Scratch &scratch) {
+  ScratchFrame frame(scratch);
+  uint32_t *product = scratch.alloc(2 * b_size);
+  std::fill(result, result + a_size + b_size, 0);
+  for (size_t i = 0; i < a_size; i += b_size) {
+    size_t chunk = std::min(b_size, a_size - i);
+    mul(a + i, chunk, b, b_size, product, scratch);
+    add(result + i, a_size + b_size - i, product, chunk + b_size, result + i);
+  }
+}
+
+} // namespace
+
+void mul_basecase(const uint32_t *a, size_t a_size, const uint32_t *b,
+                  size_t b_size, uint32_t *result) {
+  // Product of two limbs is below 10^18, 16 of them plus the limb and the
+  // carry still fit uint64_t, so rows are taken in groups of 16 and every
+  // column of a group is normalized once
+  constexpr size_t GROUP = 16;
+
+  std::fill(result, result + a_size + b_size, 0);
+  for (size_t row = 0; row < b_size; row += GROUP) {
+    size_t rows = std::min(GROUP, b_size - row);
+    const uint32_t *multipliers = b + row;
+    uint32_t *out = result + row;
+    size_t out_size = a_size + b_size - row;
+    uint64_t carry = 0;
+    size_t column = 0;
+    for (; column < a_size + rows - 1; ++column) {
+      uint64_t current = out[column] + carry;
+      size_t first = column >= a_size ? column - a_size + 1 : 0;
+      size_t last = std::min(column + 1, rows);
+      for (size_t t = first; t < last; ++t) {
+        current += static_cast<uint64_t>(a[column - t]) * multipliers[t];
+      }
+      out[column] = current % BASE;
+      carry = current / BASE;
+    }
+    for (; carry != 0 && column < out_size; ++column) {
+      uint64_t current = out[column] + carry;
+      out[column] = current % BASE;
+      carry = current / BASE;
+    }
+  }
+}
+
+void mul_karatsuba(const uint32_t *a, size_t a_size, const uint32_t *b,
+                   size_t b_size, uint32_t *result, Scratch &scratch) {
+  ScratchFrame frame(scratch);
+  size_t h = (a_size + 1) / 2;
+  size_t size = a_size + b_size;
+
+  // z0 and z2 go straight to their places in the result
+  mul(a, h, b, h, result, scratch);
+  mul(a + h, a_size - h, b + h, b_size - h, result + 2 * h, scratch);
+
+  uint32_t *a_sum = scratch.alloc(h + 1);
+  a_sum[h] = add(a, h, a + h, a_size - h, a_sum);
+  uint32_t *b_sum = scratch.alloc(h + 1);
+  b_sum[h] = add(b, h, b + h, b_size - h, b_sum);
+  size_t a_sum_size = normalized_size(a_sum, h + 1);
+  size_t b_sum_size = normalized_size(b_sum, h + 1);
+
+  uint32_t *z1 = scratch.alloc(2 * h + 2);
+  mul(a_sum, a_sum_size, b_sum, b_sum_size, z1, scratch);
+  size_t z1_size = normalized_size(z1, a_sum_size + b_sum_size);
+
+  sub(z1, z1_size, result, normalized_size(result, 2 * h), z1);
+  z1_size = normalized_size(z1, z1_size);
+  sub(z1, z1_size, result + 2 * h,
+      normalized_size(result + 2 * h, size - 2 * h), z1);
+  z1_size = normalized_size(z1, z1_size);
+
+  if (z1_size > 0) {
+    add(result + h, size - h, z1, z1_size, result + h);
+  }
+}
+
+void mul_toom3(const uint32_t *a, size_t a_size, const uint32_t *b,
+               size_t b_size, uint32_t *result, Scratch &scratch) {
+  ScratchFrame frame(scratch);
+  size_t k = (a_size + 2) / 3;
+  size_t size = a_size + b_size;
+  size_t value_size = k + 2;
+  size_t product_size = 2 * value_size;
+
+  Signed p1, pm1, pm2, q1, qm1, qm2;
+  uint32_t *a_values = scratch.alloc(3 * value_size);
+  uint32_t *b_values = scratch.alloc(3 * value_size);
+  EvaluateToom3(a, a_size, k, a_values, a_values + value_size,
+                a_values + 2 * value_size, p1, pm1, pm2);
+  EvaluateToom3(b, b_size, k, b_values, b_values + value_size,
+                b_values + 2 * value_size, q1, qm1, qm2);
+
+  // r0 = a0 * b0 and r_inf = a2 * b2 go straight to their places
+  size_t a0_size = normalized_size(a, k), b0_size = normalized_size(b, k);
+  mul(a, a0_size, b, b0_size, result, scratch);
+  std::fill(result + a0_size + b0_size, result + 4 * k, 0);
+  mul(a + 2 * k, a_size - 2 * k, b + 2 * k, b_size - 2 * k, result + 4 * k,
+      scratch);
+  Signed r0 = MakeSigned(result, 2 * k);
+  Signed r_inf = MakeSigned(result + 4 * k, size - 4 * k);
+
+  uint32_t *products = scratch.alloc(3 * product_size);
+  Signed r1 = MulSigned(p1, q1, products, scratch);
+  Signed rm1 = MulSigned(pm1, qm1, products + product_size, scratch);
+  Signed rm2 = MulSigned(pm2, qm2, products + 2 * product_size, scratch);
+
+  // Bodrato's interpolation sequence, every step keeps its buffer
+  Signed r3 = DivideExact(AddSigned(rm2, r1, rm2.data, true), 3);
+  r1 = DivideExact(AddSigned(r1, rm1, r1.data, true), 2);
+  Signed r2 = AddSigned(rm1, r0, rm1.data, true);
+  r3 = DivideExact(AddSigned(r2, r3, r3.data, true), 2);
+  r3 = AddSigned(r3, r_inf, r3.data);
+  r3 = AddSigned(r3, r_inf, r3.data);
+  r2 = AddSigned(r2, r1, r2.data);
+  r2 = AddSigned(r2, r_inf, r2.data, true);
+  r1 = AddSigned(r1, r3, r1.data, true);
+
+  // r0 and r_inf are in place, intermediate coefficients overlap them
+  AddAt(result, size, k, r1);
+  AddAt(result, size, 2 * k, r2);
+  AddAt(result, size, 3 * k, r3);
+}
+
+void mul(const uint32_t *a, size_t a_size, const uint32_t *b, size_t b_size,
+         uint32_t *result, Scratch &scratch) {
+  if (a_size < b_size) {
+    std::swap(a, b);
+    std::swap(a_size, b_size);
+  }
+
+  if (b_size == 0) {
+    std::fill(result, result + a_size, 0);
+  } else if (b_size < KARATSUBA_THRESHOLD) {
+    mul_basecase(a, a_size, b, b_size, result);
+  } else if (b_size >= NTT_THRESHOLD && a_size + b_size <= NTT_MAX_SIZE) {
+    mul_ntt(a, a_size, b, b_size, result, scratch);
+  } else if (2 * b_size <= a_size) {
+    MulUnbalanced(a, a_size, b, b_size, result, scratch);
+  } else if (b_size < TOOM3_THRESHOLD || b_size <= 2 * ((a_size + 2) / 3)) {
+    mul_karatsuba(a, a_size, b, b_size, result, scratch);
+  } else {
+    mul_toom3(a, a_size, b, b_size, result, scratch);
+  }
+}
+
+void mul(const uint32_t *a, size_t a_size, const uint32_t *b, size_t b_size,
+         uint32_t *result) {
+  Scratch scratch(b_size < KARATSUBA_THRESHOLD ? 0 : 4 * (a_size + b_size));
+  mul(a, a_size, b, b_size, result, scratch);
+}
+
+} // namespace limbs
+} // namespace bigint_huawei
@@ -0,0 +1,248 @@
+#include "bigint_limbs.h"
+
+#include <algorithm>
+
+namespace bigint_huawei {
+namespace limbs {
+
+namespace {
+
+/**
+ * Arithmetic modulo prime MOD < 2^30 in Montgomery form with R = 2^32:
+ * multiplication is two 32x32 bit products and a shift, no division.
+ */
+template <uint32_t MOD> struct Montgomery {
+  static constexpr uint32_t NegativeInverse() {
+    // Newton iteration doubles the number of correct low bits
+    uint32_t inverse = MOD;
+    for (int i = 0; i < 5; ++i) {
+      inverse *= 2 - MOD * inverse;
+    }
+    return -inverse;
+  }
+
+  static constexpr uint32_t NEG_INV = NegativeInverse();
+  static constexpr uint32_t R = (uint64_t(1) << 32) % MOD;
+  static constexpr uint32_t R2 = uint64_t(R) * R % MOD;
+
+  static uint32_t reduce(uint64_t value) {
+    uint32_t m = static_cast<uint32_t>(value) * NEG_INV;
+    uint32_t result = (value + static_cast<uint64_t>(m) * MOD) >> 32;
+    return result >= MOD ? result - MOD : result;
+  }
+  static uint32_t mul(uint32_t a, uint32_t b) {
+    return reduce(static_cast<uint64_t>(a) * b);
+  }
+  static uint32_t to_montgomery(uint32_t a) { return mul(a, R2); }
+  static uint32_t add(uint32_t a, uint32_t b) {
+    uint32_t sum = a + b;
+    return sum >= MOD ? sum - MOD : sum;
+  }
+  static uint32_t sub(uint32_t a, uint32_t b) {
+    return a >= b ? a - b : a + MOD - b;
+  }
+};
+
+constexpr uint32_t PowMod(uint64_t base, uint64_t exponent, uint32_t mod) {
+  uint64_t result = 1;
+  base %= mod;
+  while (exponent > 0) {
+    if (exponent & 1) {
+      result = result * base % mod;
+    }
+    base = base * base % mod;
+    exponent >>= 1;
+  }
+  return result;
+}
+
+// Three NTT friendly primes with primitive root 3, their product is above
+// 7.8 * 10^25 that bounds every coefficient of the convolution
+constexpr uint32_t P1 = 998244353; // 119 * 2^23 + 1
+constexpr uint32_t P2 = 167772161; // 5 * 2^25 + 1
+constexpr uint32_t P3 = 469762049; // 7 * 2^26 + 1
+constexpr uint32_t PRIMITIVE_ROOT = 3;
+
+// Transforms of up to this size fit L2 cache and run level by level
+constexpr size_t NTT_BLOCK = 1 << 15;
+
+/**
+ * Fills roots[m / 2 + j] = w_m^j for every power of two m <= n, where w_m is
+ * a primitive m-th root of unity (or its inverse). Roots are in Montgomery
+ * form, data stays in the normal one: Montgomery product of the two is the
+ * normal product.
+ */
+template <uint32_t MOD> void BuildRoots(uint32_t *roots, size_t n, bool inverse) {
+  using M = Montgomery<MOD>;
+  for (size_t half = 1; half < n; half <<= 1) {
+    uint32_t w = PowMod(PRIMITIVE_ROOT, (MOD - 1) / (2 * half), MOD);
+    if (inverse) {
+      w = PowMod(w, MOD - 2, MOD);
+    }
+    uint32_t w_montgomery = M::to_montgomery(w);
+    roots[half] = M::to_montgomery(1);
+    for (size_t j = 1; j < half; ++j) {
+      roots[half + j] = M::mul(roots[half + j - 1], w_montgomery);
+    }
+  }
+}
+
+/**
+ * Decimation in frequency transform: natural order in, bit reversed out.
+ *
+ * Large transforms are cache blocked: the top level butterflies touch the
+ * whole array once, then every half is transformed recursively, so all
+ * levels below NTT_BLOCK run inside the cache.
+ */
+template <uint32_t MOD>
+void Forward(uint32_t *a, size_t n, const uint32_t *roots) {
+  using M = Montgomery<MOD>;
+  if (n > NTT_BLOCK) {
+    size_t half = n / 2;
+    const uint32_t *w = roots + half;
+    for (size_t j = 0; j < half; ++j) {
+      uint32_t u = a[j], v = a[j + half];
+      a[j] = M::add(u, v);
+      a[j + half] = M::mul(M::sub(u, v), w[j]);
+    }
+    Forward<MOD>(a, half, roots);
+    Forward<MOD>(a + half, half, roots);
+    return;
+  }
+
+  for (size_t half = n / 2; half > 0; half /= 2) {
+    const uint32_t *w = roots + half;
+    for (size_t start = 0; start < n; start += 2 * half) {
+      uint32_t *block = a + start;
+      for (size_t j = 0; j < half; ++j) {
+        uint32_t u = block[j], v = block[j + half];
+        block[j] = M::add(u, v);
+        block[j + half] = M::mul(M::sub(u, v), w[j]);
+      }
+    }
+  }
+}
+
+/**
+ * Decimation in time transform with inverse roots: bit reversed in, natural
+ * order out (not scaled by 1/n). Cache blocked the same way as Forward.
+ */
+template <uint32_t MOD>
+void Inverse(uint32_t *a, size_t n, const uint32_t *roots) {
+  using M = Montgomery<MOD>;
+  if (n > NTT_BLOCK) {
+    size_t half = n / 2;
+    Inverse<MOD>(a, half, roots);
+    Inverse<MOD>(a + half, half, roots);
+    const uint32_t *w = roots + half;
+    for (size_t j = 0; j < half; ++j) {
+      uint32_t u = a[j], v = M::mul(a[j + half], w[j]);
+      a[j] = M::add(u, v);
+      a[j + half] = M::sub(u, v);
+    }
+    return;
+  }
+
+  for (size_t half = 1; half < n; half *= 2) {
+    const uint32_t *w = roots + half;
+    for (size_t start = 0; start < n; start += 2 * half) {
+      uint32_t *block = a + start;
+      for (size_t j = 0; j < half; ++j) {
+        uint32_t u = block[j], v = M::mul(block[j + half], w[j]);
+        block[j] = M::add(u, v);
+        block[j + half] = M::sub(u, v);
+      }
+    }
+  }
+}
+
+/**
+ * Cyclic convolution of a and b modulo MOD of length n, the result is
+ * written to out. b_transform and roots are buffers of n elements.
+ */
+template <uint32_t MOD>
+void Convolve(const uint32_t *a, size_t a_size, const uint32_t *b,
+              size_t b_size, uint32_t *out, size_t n, uint32_t *b_transform,
+              uint32_t *roots) {
+  using M = Montgomery<MOD>;
+  bool square = a == b && a_size == b_size;
+
+  BuildRoots<MOD>(roots, n, false);
+  for (size_t i = 0; i < a_size; ++i) {
+    out[i] = a[i] % MOD;
+  }
+  std::fill(out + a_size, out + n, 0);
+  Forward<MOD>(out, n, roots);
+
+  if (square) {
+    b_transform = out;
+  } else {
+    for (size_t i = 0; i < b_size; ++i) {
+      b_transform[i] = b[i] % MOD;
+    }
+    std::fill(b_transform + b_size, b_transform + n, 0);
+    Forward<MOD>(b_transform, n, roots);
+  }
+
+  // Pointwise Montgomery product leaves extra 1/R, it is compensated by the
+  // final scale R / n (in Montgomery form: R^2 / n)
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = M::mul(out[i], b_transform[i]);
+  }
+
+  BuildRoots<MOD>(roots, n, true);
+  Inverse<MOD>(out, n, roots);
+  uint32_t scale = M::to_montgomery(
+      M::to_montgomery(PowMod(n % MOD, MOD - 2, MOD)));
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = M::mul(out[i], scale);
+  }
+}
+
+} // namespace
+
+void mul_ntt(const uint32_t *a, size_t a_size, const uint32_t *b,
+             size_t b_size, uint32_t *result, Scratch &scratch) {
+  ScratchFrame frame(scratch);
+  size_t size = a_size + b_size;
+  size_t n = 1;
+  while (n < size - 1) {
+    n <<= 1;
+  }
+
+  uint32_t *r1 = scratch.alloc(n);
+  uint32_t *r2 = scratch.alloc(n);
+  uint32_t *r3 = scratch.alloc(n);
+  uint32_t *b_transform = scratch.alloc(n);
+  uint32_t *roots = scratch.alloc(n);
+  Convolve<P1>(a, a_size, b, b_size, r1, n, b_transform, roots);
+  Convolve<P2>(a, a_size, b, b_size, r2, n, b_transform, roots);
+  Convolve<P3>(a, a_size, b, b_size, r3, n, b_transform, roots);
+
+  // Garner's CRT: c = v1 + P1 * (v2 + P2 * v3), the inner part t fits
+  // uint64_t, so c = (v1 + P1 * (t % BASE)) + P1 * (t / BASE) * BASE is
+  // split into a limb and the part that goes to the next limb
+  constexpr uint32_t P1_INV_P2 = PowMod(P1, P2 - 2, P2);
+  constexpr uint32_t P1_INV_P3 = PowMod(P1, P3 - 2, P3);
+  constexpr uint32_t P2_INV_P3 = PowMod(P2, P3 - 2, P3);
+  uint64_t carry = 0;
+  for (size_t k = 0; k < size; ++k) {
+    uint64_t low = carry, high = 0;
+    if (k < size - 1) {
+      uint64_t v1 = r1[k];
+      uint64_t v2 = (r2[k] + P2 - v1 % P2) * P1_INV_P2 % P2;
+      uint64_t v3 =
+          ((r3[k] + P3 - v1 % P3) * P1_INV_P3 % P3 + P3 - v2) % P3 *
+          P2_INV_P3 % P3;
+      uint64_t t = v2 + P2 * v3;
+      uint64_t part = v1 + P1 * (t % BASE);
+      low += part % BASE;
+      high = part / BASE + P1 * (t / BASE);
+    }
+    result[k] = low % BASE;
+    carry = low / BASE + high;
+  }
+}
+
+} // namespace limbs
+} // namespace bigint_huawei
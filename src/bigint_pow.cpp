@@ -0,0 +1,299 @@
+#include "bigint_limbs.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace bigint_huawei {
+namespace limbs {
+
+namespace {
+
+/**
+ * Multiplies residues of n limbs (leading zero limbs allowed) into product
+ * of 2n + 1 limbs.
+ */
+void MulResidues(const uint32_t *a, const uint32_t *b, size_t n,
+                 uint32_t *product, Scratch &scratch) {
+  size_t a_size = normalized_size(a, n);
+  size_t b_size = normalized_size(b, n);
+  std::fill(product, product + 2 * n + 1, 0);
+  if (a_size > 0 && b_size > 0) {
+    mul(a, a_size, b, b_size, product, scratch);
+  }
+}
+
+/**
+ * Montgomery arithmetic modulo m of n limbs with R = B^n, m must be coprime
+ * with the base (not divisible by 2 and 5). Residues are kept as aR mod m,
+ * then the product of two residues is reduced by REDC without division:
+ * every step adds a multiple of m that zeroes the lowest limb.
+ */
+class MontgomeryReducer {
+  const uint32_t *modulus;
+  size_t n;
+  uint32_t inverse; // -m^(-1) mod B
+  Scratch &scratch;
+  std::vector<uint32_t> product;
+  std::vector<uint64_t> factors;
+  std::vector<uint32_t> reduced;
+
+public:
+  MontgomeryReducer(const uint32_t *modulus, size_t n, Scratch &scratch)
+      : modulus(modulus), n(n), scratch(scratch), product(2 * n + 1),
+        factors(n), reduced(n + 1) {
+    // Inverse modulo 10 lifted by Newton steps x = x * (2 - m * x), every
+    // step doubles the number of correct digits
+    static const uint64_t INVERSE_MOD_10[10] = {0, 1, 0, 7, 0, 0, 0, 3, 0, 9};
+    uint64_t m = modulus[0];
+    uint64_t x = INVERSE_MOD_10[m % 10];
+    for (int i = 0; i < 4; ++i) {
+      x = x * ((2 + BASE - m * x % BASE) % BASE) % BASE;
+    }
+    inverse = (BASE - x) % BASE;
+  }
+
+  size_t size() const { return n; }
+
+  /**
+   * result = a * R mod m for a < m.
+   */
+  void to_form(const uint32_t *a, uint32_t *result) {
+    ScratchFrame frame(scratch);
+    size_t a_size = normalized_size(a, n);
+    uint32_t *shifted = scratch.alloc(n + a_size);
+    std::fill(shifted, shifted + n, 0);
+    std::copy(a, a + a_size, shifted + n);
+    if (a_size == 0) {
+      std::fill(result, result + n, 0);
+      return;
+    }
+    uint32_t *quotient = scratch.alloc(a_size + 1);
+    divmod(shifted, n + a_size, modulus, n, quotient, result, scratch);
+  }
+
+  /**
+   * result = a * b / R mod m.
+   */
+  void mul(const uint32_t *a, const uint32_t *b, uint32_t *result) {
+    MulResidues(a, b, n, product.data(), scratch);
+    reduce(result);
+  }
+
+  /**
+   * result = a / R mod m, the number itself.
+   */
+  void from_form(const uint32_t *a, uint32_t *result) {
+    std::fill(product.begin(), product.end(), 0);
+    std::copy(a, a + n, product.begin());
+    reduce(result);
+  }
+
+private:
+  /**
+   * REDC by columns: limb k of t + u * m is summed in one pass, u[k] is
+   * chosen on the way so the lowest n limbs become zero. Products are summed
+   * in uint64 by groups of 16 with one carry split per group.
+   */
+  void reduce(uint32_t *result) {
+    const uint32_t *t = product.data();
+    uint64_t carry = 0;
+    for (size_t k = 0; k < 2 * n; ++k) {
+      uint64_t high = 0, low = carry + t[k];
+      size_t first = k < n ? 0 : k - n + 1;
+      size_t last = k < n ? k : n;
+      for (size_t i = first; i < last; i += 16) {
+        size_t end = std::min(last, i + 16);
+        for (size_t j = i; j < end; ++j) {
+          low += factors[j] * modulus[k - j];
+        }
+        high += low / BASE;
+        low %= BASE;
+      }
+      high += low / BASE;
+      low %= BASE;
+      if (k < n) {
+        factors[k] = low * inverse % BASE;
+        low += factors[k] * modulus[0];
+      } else {
+        reduced[k - n] = low % BASE;
+      }
+      carry = high + low / BASE;
+    }
+    reduced[n] = carry;
+
+    // t / R is below 2m
+    if (reduced[n] > 0 ||
+        compare(reduced.data(), normalized_size(reduced.data(), n), modulus,
+                n) >= 0) {
+      sub(reduced.data(), n + 1, modulus, n, reduced.data());
+    }
+    std::copy(reduced.begin(), reduced.begin() + n, result);
+  }
+};
+
+/**
+ * Barrett arithmetic modulo any m of n limbs: the quotient of the product
+ * by m is estimated with the precomputed reciprocal floor(B^(2n) / m) and
+ * is at most 2 below the real one.
+ */
+class BarrettReducer {
+  const uint32_t *modulus;
+  size_t n;
+  Scratch &scratch;
+  std::vector<uint32_t> reciprocal_limbs;
+  size_t reciprocal_size;
+  std::vector<uint32_t> product;
+  std::vector<uint32_t> estimate;
+  std::vector<uint32_t> qm;
+
+public:
+  BarrettReducer(const uint32_t *modulus, size_t n, Scratch &scratch)
+      : modulus(modulus), n(n), scratch(scratch), reciprocal_limbs(n + 3),
+        product(2 * n + 1), estimate(3 * n + 4), qm(3 * n + 4) {
+    reciprocal_size = reciprocal(modulus, n, reciprocal_limbs.data(), scratch);
+  }
+
+  size_t size() const { return n; }
+
+  void to_form(const uint32_t *a, uint32_t *result) {
+    std::copy(a, a + n, result);
+  }
+
+  void from_form(const uint32_t *a, uint32_t *result) {
+    std::copy(a, a + n, result);
+  }
+
+  /**
+   * result = a * b mod m.
+   */
+  void mul(const uint32_t *a, const uint32_t *b, uint32_t *result) {
+    MulResidues(a, b, n, product.data(), scratch);
+    uint32_t *t = product.data();
+    size_t t_size = normalized_size(t, 2 * n);
+    if (t_size == 0) {
+      std::fill(result, result + n, 0);
+      return;
+    }
+
+    // q = t * x / B^(2n)
+    limbs::mul(t, t_size, reciprocal_limbs.data(), reciprocal_size,
+               estimate.data(), scratch);
+    size_t estimate_size =
+        normalized_size(estimate.data(), t_size + reciprocal_size);
+    const uint32_t *q = estimate.data() + std::min(2 * n, estimate_size);
+    size_t q_size = estimate_size > 2 * n ? estimate_size - 2 * n : 0;
+
+    // t -= q * m
+    if (q_size > 0) {
+      limbs::mul(q, q_size, modulus, n, qm.data(), scratch);
+      size_t qm_size = normalized_size(qm.data(), q_size + n);
+      sub(t, t_size, qm.data(), qm_size, t);
+      t_size = normalized_size(t, t_size);
+    }
+    while (compare(t, t_size, modulus, n) >= 0) {
+      sub(t, t_size, modulus, n, t);
+      t_size = normalized_size(t, t_size);
+    }
+    std::fill(result, result + n, 0);
+    std::copy(t, t + t_size, result);
+  }
+};
+
+/**
+ * Exponent as binary words of 29 bits, the lowest word goes first. Every
+ * step divides the decimal limbs by 2^29.
+ */
+std::vector<uint32_t> ToBinary(const uint32_t *exponent, size_t size) {
+  constexpr uint32_t WORD = uint32_t(1) << 29;
+  std::vector<uint32_t> number(exponent, exponent + size);
+  std::vector<uint32_t> words;
+  while (size > 0) {
+    words.push_back(div_1(number.data(), size, WORD, number.data()));
+    size = normalized_size(number.data(), size);
+  }
+  return words;
+}
+
+/**
+ * Left to right sliding window exponentiation, residues are in the form of
+ * the reducer. Window width grows with the exponent length, the table keeps
+ * odd powers x, x^3, ..., x^(2^w - 1).
+ */
+template <typename Reducer>
+void PowWindow(Reducer &reducer, const uint32_t *base,
+               const std::vector<uint32_t> &exponent, uint32_t *result) {
+  size_t n = reducer.size();
+  auto bit = [&](size_t i) { return (exponent[i / 29] >> (i % 29)) & 1; };
+  size_t bits = 29 * exponent.size();
+  while (bits > 0 && !bit(bits - 1)) {
+    --bits;
+  }
+
+  size_t width = bits <= 24 ? 1 : bits <= 80 ? 3 : bits <= 240 ? 4
+                                : bits <= 672 ? 5 : 6;
+  std::vector<uint32_t> table(n << (width - 1));
+  reducer.to_form(base, table.data());
+  if (width > 1) {
+    std::vector<uint32_t> square(n);
+    reducer.mul(table.data(), table.data(), square.data());
+    for (size_t k = 1; k < (size_t(1) << (width - 1)); ++k) {
+      reducer.mul(table.data() + (k - 1) * n, square.data(),
+                  table.data() + k * n);
+    }
+  }
+
+  std::vector<uint32_t> one(n, 0);
+  one[0] = 1;
+  reducer.to_form(one.data(), result);
+  bool started = false;
+  size_t i = bits;
+  while (i > 0) {
+    if (!bit(i - 1)) {
+      if (started) {
+        reducer.mul(result, result, result);
+      }
+      --i;
+      continue;
+    }
+    // Longest window [j, i) not wider than width ending with a set bit
+    size_t j = i > width ? i - width : 0;
+    while (!bit(j)) {
+      ++j;
+    }
+    uint32_t value = 0;
+    for (size_t k = i; k > j; --k) {
+      value = (value << 1) | bit(k - 1);
+      if (started) {
+        reducer.mul(result, result, result);
+      }
+    }
+    const uint32_t *power = table.data() + (value >> 1) * n;
+    if (started) {
+      reducer.mul(result, power, result);
+    } else {
+      std::copy(power, power + n, result);
+      started = true;
+    }
+    i = j;
+  }
+  reducer.from_form(result, result);
+}
+
+} // namespace
+
+void powmod(const uint32_t *base, const uint32_t *exponent,
+            size_t exponent_size, const uint32_t *modulus, size_t n,
+            uint32_t *result) {
+  Scratch scratch(16 * n + 64);
+  std::vector<uint32_t> binary = ToBinary(exponent, exponent_size);
+  if (modulus[0] % 2 != 0 && modulus[0] % 5 != 0) {
+    MontgomeryReducer reducer(modulus, n, scratch);
+    PowWindow(reducer, base, binary, result);
+  } else {
+    BarrettReducer reducer(modulus, n, scratch);
+    PowWindow(reducer, base, binary, result);
+  }
+}
+
+} // namespace limbs
+} // namespace bigint_huawei
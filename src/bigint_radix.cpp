@@ -0,0 +1,43 @@
+#include "bigint_limbs.h"
+
+#include <algorithm>
+
+namespace bigint_huawei {
+namespace limbs {
+
+size_t from_binary(const uint32_t *words, size_t n, uint32_t *result) {
+  // Horner's scheme: result = result * 2^32 + word, every product of a limb
+  // and 2^32 with the carry fits into uint64
+  size_t size = 0;
+  for (size_t i = n; i > 0; --i) {
+    uint64_t carry = words[i - 1];
+    for (size_t j = 0; j < size; ++j) {
+      uint64_t current = (static_cast<uint64_t>(result[j]) << 32) + carry;
+      result[j] = current % BASE;
+      carry = current / BASE;
+    }
+    while (carry > 0) {
+      result[size++] = carry % BASE;
+      carry /= BASE;
+    }
+  }
+  return size;
+}
+
+void to_binary(uint32_t *a, size_t size, uint32_t *words, size_t n) {
+  // Every pass divides the number by 2^32, the remainder is the next word
+  size = normalized_size(a, size);
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t remainder = 0;
+    for (size_t j = size; j > 0; --j) {
+      uint64_t current = remainder * BASE + a[j - 1];
+      a[j - 1] = current >> 32;
+      remainder = current & 0xffffffffu;
+    }
+    words[i] = remainder;
+    size = normalized_size(a, size);
+  }
+}
+
+} // namespace limbs
+} // namespace bigint_huawei
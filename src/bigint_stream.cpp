@@ -0,0 +1,276 @@
+#include "bigint_stream.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bigint_huawei {
+
+using namespace std::literals::string_literals;
+using std::string;
+
+namespace {
+
+[[noreturn]] void ThrowSystemError(const string &action, const string &path) {
+  throw std::runtime_error("Can not "s + action + " "s + path + ": "s +
+                           std::strerror(errno));
+}
+
+/**
+ * Read only memory map of the whole file.
+ */
+class MappedFile {
+  const char *data = nullptr;
+  size_t size = 0;
+
+public:
+  explicit MappedFile(const string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      ThrowSystemError("open"s, path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+      close(fd);
+      ThrowSystemError("stat"s, path);
+    }
+    size = info.st_size;
+    if (size > 0) {
+      void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map == MAP_FAILED) {
+        close(fd);
+        ThrowSystemError("map"s, path);
+      }
+      data = static_cast<const char *>(map);
+      madvise(map, size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+  }
+  ~MappedFile() {
+    if (data != nullptr) {
+      munmap(const_cast<char *>(data), size);
+    }
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *begin() const { return data; }
+  const char *end() const { return data + size; }
+
+  /**
+   * Drops cached pages that lie inside [from, to), they are read again from
+   * the file if needed.
+   */
+  void drop(const char *from, const char *to) const {
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t first = (reinterpret_cast<uintptr_t>(from) + page - 1) / page;
+    uintptr_t last = reinterpret_cast<uintptr_t>(to) / page;
+    if (first < last) {
+      madvise(reinterpret_cast<void *>(first * page), (last - first) * page,
+              MADV_DONTNEED);
+    }
+  }
+};
+
+/**
+ * Significant digits of the number in the file (no leading zeroes and
+ * whitespaces), digits are validated while they are added.
+ */
+struct Digits {
+  const char *data;
+  size_t size;
+  const string &path;
+
+  uint32_t at(size_t position) const {
+    if (position >= size) {
+      return 0;
+    }
+    char digit = data[size - 1 - position];
+    if (digit < '0' || digit > '9') {
+      throw std::invalid_argument("Expected positive integer in "s + path +
+                                  ", got '"s + digit + "'"s);
+    }
+    return digit - '0';
+  }
+};
+
+Digits FindDigits(const MappedFile &file, const string &path) {
+  const char *begin = file.begin(), *end = file.end();
+  while (begin != end && std::isspace(static_cast<unsigned char>(*begin))) {
+    ++begin;
+  }
+  while (begin != end && std::isspace(static_cast<unsigned char>(end[-1]))) {
+    --end;
+  }
+  if (begin == end) {
+    throw std::invalid_argument("Expected positive integer in "s + path +
+                                ", got empty file"s);
+  }
+  while (begin != end && *begin == '0') {
+    ++begin;
+  }
+  return {begin, static_cast<size_t>(end - begin), path};
+}
+
+void WriteAt(int fd, const char *data, size_t size, size_t offset,
+             const string &path) {
+  while (size > 0) {
+    ssize_t written = pwrite(fd, data, size, offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ThrowSystemError("write"s, path);
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+}
+
+/**
+ * Carry out of the top digit: the first position from the top where the
+ * digits do not sum to 9 decides it, a run of 9 only passes the carry from
+ * below.
+ */
+uint32_t TopCarry(const Digits &first, const Digits &second, size_t length) {
+  for (size_t position = length; position > 0; --position) {
+    uint32_t sum = first.at(position - 1) + second.at(position - 1);
+    if (sum != 9) {
+      return sum >= 10;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Adds digits at positions [low, high) and writes them to the chunk buffer
+ * (the most significant first). Digits are validated once per chunk, the
+ * loop itself has no branches.
+ *
+ * @return carry out
+ */
+uint32_t AddChunk(const Digits &first, const Digits &second, size_t low,
+                  size_t high, uint32_t carry, char *out) {
+  const Digits &longer = first.size >= second.size ? first : second;
+  const Digits &shorter = first.size >= second.size ? second : first;
+  // p-th digit from the end is at end[-p]
+  const char *longer_end = longer.data + longer.size - 1;
+  const char *shorter_end = shorter.data + shorter.size - 1;
+
+  uint32_t invalid = 0;
+  size_t position = low;
+  for (size_t common = std::min(high, shorter.size); position < common;
+       ++position) {
+    uint32_t x = longer_end[-position] - '0';
+    uint32_t y = shorter_end[-position] - '0';
+    invalid |= (x > 9) | (y > 9);
+    uint32_t sum = x + y + carry;
+    carry = sum >= 10;
+    out[high - 1 - position] = '0' + sum - 10 * carry;
+  }
+  for (; position < high; ++position) {
+    uint32_t x = longer_end[-position] - '0';
+    invalid |= x > 9;
+    uint32_t sum = x + carry;
+    carry = sum >= 10;
+    out[high - 1 - position] = '0' + sum - 10 * carry;
+  }
+
+  if (invalid) {
+    // Find the bad digit to report it
+    for (position = low; position < high; ++position) {
+      first.at(position);
+      second.at(position);
+    }
+  }
+  return carry;
+}
+
+/**
+ * Checks whether two paths name the same file (device and inode), a path
+ * that does not exist names no file.
+ */
+bool SameFile(const string &first_path, const string &second_path) {
+  struct stat first, second;
+  return stat(first_path.c_str(), &first) == 0 &&
+         stat(second_path.c_str(), &second) == 0 &&
+         first.st_dev == second.st_dev && first.st_ino == second.st_ino;
+}
+
+} // namespace
+
+void add_files(const string &first_path, const string &second_path,
+               const string &output_path, size_t chunk_digits) {
+  if (chunk_digits == 0) {
+    throw std::invalid_argument("Expected positive chunk size, got 0"s);
+  }
+  // Truncating the output would cut an input while it is still mapped
+  for (const string *input : {&first_path, &second_path}) {
+    if (SameFile(*input, output_path)) {
+      throw std::invalid_argument("Output file "s + output_path +
+                                  " is also an input"s);
+    }
+  }
+
+  MappedFile first_file(first_path), second_file(second_path);
+  Digits first = FindDigits(first_file, first_path);
+  Digits second = FindDigits(second_file, second_path);
+
+  size_t length = std::max(first.size, second.size);
+  uint32_t top_carry = TopCarry(first, second, length);
+  size_t total = std::max<size_t>(length + top_carry, 1);
+
+  int fd = open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    ThrowSystemError("open"s, output_path);
+  }
+  try {
+    if (ftruncate(fd, total + 1) != 0) {
+      ThrowSystemError("resize"s, output_path);
+    }
+    WriteAt(fd, "\n", 1, total, output_path);
+    if (length == 0) {
+      WriteAt(fd, "0", 1, 0, output_path);
+    }
+
+    // Sum digit at position p goes to the offset total - 1 - p
+    std::vector<char> buffer(std::min(chunk_digits, length));
+    uint32_t carry = 0;
+    for (size_t low = 0; low < length; low += chunk_digits) {
+      size_t high = std::min(length, low + chunk_digits);
+      carry = AddChunk(first, second, low, high, carry, buffer.data());
+      WriteAt(fd, buffer.data(), high - low, total - high, output_path);
+
+      for (const Digits *digits : {&first, &second}) {
+        if (low < digits->size) {
+          const char *end = digits->data + digits->size - low;
+          const MappedFile &file =
+              digits == &first ? first_file : second_file;
+          file.drop(end - (std::min(high, digits->size) - low), end);
+        }
+      }
+    }
+    if (top_carry) {
+      WriteAt(fd, "1", 1, 0, output_path);
+    }
+  } catch (...) {
+    close(fd);
+    unlink(output_path.c_str());
+    throw;
+  }
+  if (close(fd) != 0) {
+    ThrowSystemError("close"s, output_path);
+  }
+}
+
+} // namespace bigint_huawei
@@ -0,0 +1,87 @@
+#include "bigint_tree.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "bigint_accumulator.h"
+
+namespace bigint_huawei {
+
+using thread_pool_huawei::ThreadPool;
+
+namespace {
+
+/**
+ * Product of numbers[first, last) by a balanced tree.
+ */
+BigInt MultiplyRange(const std::vector<BigInt> &numbers, size_t first,
+                     size_t last) {
+  if (last - first == 1) {
+    return numbers[first];
+  }
+  size_t middle = first + (last - first) / 2;
+  return MultiplyRange(numbers, first, middle) *
+         MultiplyRange(numbers, middle, last);
+}
+
+/**
+ * Splits numbers into blocks, reduces every block on the pool, then combines
+ * neighbouring results level by level, every level in parallel.
+ */
+BigInt ReduceTree(
+    const std::vector<BigInt> &numbers, ThreadPool &pool,
+    const std::function<BigInt(size_t, size_t)> &reduce_block,
+    const std::function<BigInt(const BigInt &, const BigInt &)> &combine) {
+  // A few blocks per thread keep the pool busy when blocks are uneven
+  size_t blocks = std::min(numbers.size(), 4 * (pool.size() + 1));
+  std::vector<BigInt> level(blocks);
+  pool.parallel_for(blocks, [&](size_t block) {
+    level[block] = reduce_block(numbers.size() * block / blocks,
+                                numbers.size() * (block + 1) / blocks);
+  });
+
+  while (level.size() > 1) {
+    std::vector<BigInt> next((level.size() + 1) / 2);
+    pool.parallel_for(level.size() / 2, [&](size_t i) {
+      next[i] = combine(level[2 * i], level[2 * i + 1]);
+    });
+    if (level.size() % 2 != 0) {
+      next.back() = std::move(level.back());
+    }
+    level = std::move(next);
+  }
+  return std::move(level.front());
+}
+
+} // namespace
+
+BigInt product_tree(const std::vector<BigInt> &numbers, ThreadPool &pool) {
+  if (numbers.empty()) {
+    return BigInt(1);
+  }
+  return ReduceTree(
+      numbers, pool,
+      [&](size_t first, size_t last) {
+        return MultiplyRange(numbers, first, last);
+      },
+      [](const BigInt &a, const BigInt &b) { return a * b; });
+}
+
+BigInt sum_tree(const std::vector<BigInt> &numbers, ThreadPool &pool) {
+  if (numbers.empty()) {
+    return BigInt();
+  }
+  return ReduceTree(
+      numbers, pool,
+      [&](size_t first, size_t last) {
+        BigIntAccumulator accumulator;
+        for (size_t i = first; i < last; ++i) {
+          accumulator += numbers[i];
+        }
+        return accumulator.finish();
+      },
+      [](const BigInt &a, const BigInt &b) { return a + b; });
+}
+
+} // namespace bigint_huawei
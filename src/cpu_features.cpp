@@ -0,0 +1,77 @@
+#include "cpu_features.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace cpu_huawei {
+
+namespace {
+
+constexpr const char *LEVEL_NAMES[SIMD_LEVELS] = {"scalar", "sse2", "avx2",
+                                                  "avx512"};
+
+SimdLevel DetectLevel() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  // AVX-512 kernels use only the foundation subset
+  if (__builtin_cpu_supports("avx512f")) {
+    return SimdLevel::avx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return SimdLevel::avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return SimdLevel::sse2;
+  }
+#endif
+  return SimdLevel::scalar;
+}
+
+/**
+ * Detected level lowered by SIMD_ENV.
+ */
+SimdLevel StartupLevel() {
+  SimdLevel level = detected_simd_level();
+  const char *forced = std::getenv(SIMD_ENV);
+  if (forced == nullptr) {
+    return level;
+  }
+  for (int i = 0; i < SIMD_LEVELS; ++i) {
+    if (std::strcmp(forced, LEVEL_NAMES[i]) == 0) {
+      return static_cast<SimdLevel>(std::min(static_cast<int>(level), i));
+    }
+  }
+  return level;
+}
+
+std::atomic<SimdLevel> &CurrentLevel() {
+  static std::atomic<SimdLevel> level(StartupLevel());
+  return level;
+}
+
+} // namespace
+
+SimdLevel detected_simd_level() {
+  static const SimdLevel level = DetectLevel();
+  return level;
+}
+
+SimdLevel simd_level() {
+  return CurrentLevel().load(std::memory_order_relaxed);
+}
+
+SimdLevel set_simd_level(SimdLevel level) {
+  if (static_cast<int>(level) > static_cast<int>(detected_simd_level())) {
+    level = detected_simd_level();
+  }
+  CurrentLevel().store(level, std::memory_order_relaxed);
+  return level;
+}
+
+const char *simd_level_name(SimdLevel level) {
+  return LEVEL_NAMES[static_cast<int>(level)];
+}
+
+} // namespace cpu_huawei
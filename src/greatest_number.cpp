@@ -1,39 +1,209 @@
 #include "greatest_number.h"
 
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "cpu_features.h"
+
 namespace gn_huawei {
 
+using thread_pool_huawei::ThreadPool;
+
 /**
- * Finds the closest to the limit sum.
- * Can be picked at most 4 numbers (numbers can be repeated).
+ * Scalar kernel of CountNotAbove.
+ */
+static size_t CountNotAboveScalar(const unsigned int *sums, size_t n,
+                                  unsigned int value) {
+  while (n > 0 && sums[n - 1] > value) {
+    --n;
+  }
+  return n;
+}
+
+#if defined(__x86_64__)
+
+/**
+ * Skips 8 sums per step while the whole block is above the value, the block
+ * with the answer gives the number of sums above the value in it.
+ */
+__attribute__((target("avx2,popcnt"))) static size_t
+CountNotAboveAvx2(const unsigned int *sums, size_t n, unsigned int value) {
+  // x <= value when max(x, value) == value
+  const __m256i values = _mm256_set1_epi32(value);
+  for (; n >= 8; n -= 8) {
+    __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sums + n - 8));
+    __m256i not_above =
+        _mm256_cmpeq_epi32(_mm256_max_epu32(block, values), values);
+    unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(not_above));
+    if (mask != 0) {
+      return n - 8 + __builtin_popcount(mask);
+    }
+  }
+  return CountNotAboveScalar(sums, n, value);
+}
+
+#endif
+
+typedef size_t (*CountNotAboveKernel)(const unsigned int *, size_t,
+                                      unsigned int);
+
+/**
+ * Counts sums that are not above the value, sums are sorted. Sums are
+ * scanned down from the top, so the cost is the number of sums above the
+ * value: the pointer of the two pointer sweep only moves down.
  *
- * Note: input array of numbers is modified (sorted)
+ * The kernel is picked by cpu_huawei::simd_level().
+ *
+ * Time complexity: O(K) where K is a number of sums above the value
+ * Space complexity: O(1)
+ */
+static size_t CountNotAbove(const unsigned int *sums, size_t n,
+                            unsigned int value) {
+#if defined(__x86_64__)
+  static constexpr CountNotAboveKernel KERNELS[cpu_huawei::SIMD_LEVELS] = {
+      CountNotAboveScalar, CountNotAboveScalar, CountNotAboveAvx2,
+      CountNotAboveAvx2};
+  return KERNELS[static_cast<int>(cpu_huawei::simd_level())](sums, n, value);
+#else
+  return CountNotAboveScalar(sums, n, value);
+#endif
+}
+
+/**
+ * Sums count from which RadixSort stops using std::sort, and the bits of
+ * a digit (3 passes cover 32-bit sums).
+ */
+constexpr size_t RADIX_SORT_THRESHOLD = 1024;
+constexpr int RADIX_BITS = 11;
+constexpr int RADIX_PASSES = 3;
+constexpr size_t RADIX = size_t(1) << RADIX_BITS;
+
+/**
+ * Smallest number of sums in a block of the parallel two sums engine, and
+ * the number of first sums after which a block of the parallel sweep checks
+ * whether another block has hit the limit.
+ */
+constexpr size_t PARALLEL_MIN_BLOCK = size_t(1) << 15;
+constexpr size_t PARALLEL_CHECK_PERIOD = 1024;
+
+/**
+ * LSD radix sort of sums, scratch is the buffer for the passes and can be
+ * reused by the caller between sorts.
+ *
+ * Counts of all passes are collected in one read of the sums, a pass whose
+ * digit is the same for all sums is skipped (sums are not above the limit,
+ * so the top digit often is).
+ *
+ * Time complexity: O(N) where N is a number of sums
+ * Space complexity: O(N) where N is a number of sums
+ */
+static void RadixSort(std::vector<unsigned int> &sums,
+                      std::vector<unsigned int> &scratch) {
+  if (sums.size() < RADIX_SORT_THRESHOLD) {
+    sort(sums.begin(), sums.end());
+    return;
+  }
+
+  size_t counts[RADIX_PASSES][RADIX] = {};
+  for (unsigned int sum : sums) {
+    for (int pass = 0; pass < RADIX_PASSES; ++pass) {
+      ++counts[pass][(sum >> (pass * RADIX_BITS)) & (RADIX - 1)];
+    }
+  }
+
+  scratch.resize(sums.size());
+  for (int pass = 0; pass < RADIX_PASSES; ++pass) {
+    int shift = pass * RADIX_BITS;
+    size_t *count = counts[pass];
+    if (count[(sums[0] >> shift) & (RADIX - 1)] == sums.size()) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (size_t digit = 0; digit < RADIX; ++digit) {
+      offset += std::exchange(count[digit], offset);
+    }
+    for (unsigned int sum : sums) {
+      scratch[count[(sum >> shift) & (RADIX - 1)]++] = sum;
+    }
+    sums.swap(scratch);
+  }
+}
+
+/**
+ * Finds the greatest sum of two sums (a sum may be taken twice) that is
+ * not above the limit, sums are sorted. Returns 0 if there is none.
  *
- * The below algorithm finds all two sums first and saves them.
- * Then it sums two sums and updates better maximum.
+ * The best pair of a larger first sum is never above the best pair of a
+ * smaller one, so the second pointer (end of the candidate range) only
+ * moves down. Pairs below the first sum were seen from the other side, so
+ * the sweep stops when the first sum is above the half of the limit.
+ *
+ * Time complexity: O(N) where N is a number of sums
+ * Space complexity: O(1)
+ */
+static unsigned int SweepTwoSums(const unsigned int *sums, size_t n,
+                                 unsigned int limit) {
+  unsigned int max_sum = 0;
+  size_t end = std::upper_bound(sums, sums + n, limit) - sums;
+  for (size_t i = 0; i < end; ++i) {
+    if (sums[i] > limit / 2) {
+      break;
+    }
+
+    // Not empty: the first sum itself fits
+    end = i + CountNotAbove(sums + i, end - i, limit - sums[i]);
+
+    unsigned int sum = sums[i] + sums[end - 1];
+    if (sum == limit) {
+      return sum;
+    }
+
+    if (max_sum < sum) {
+      max_sum = sum;
+    }
+  }
+  return max_sum;
+}
+
+/**
+ * Two sums engine of FindGreatestNumber, numbers are sorted.
+ *
+ * The below algorithm finds all two sums first and saves them, single
+ * numbers are saved too (a number plus nothing), so that sums of two of
+ * them cover any 1 to 4 numbers. Then it sums two sums with a two pointer
+ * sweep over the sorted two sums: the first pointer goes up from the
+ * smallest sum, the second one goes down from the largest one to the best
+ * pair of the first sum.
  *
  * Two optimize performance, sorting is used for:
  *  - To detect earlier if we can get out of loop
- *  - To use binary search to reduce two sums operations
+ *  - To find the best pair of every two sum in one linear pass
  *
- * Time complexity: O((N^2)logN) where N is a number of numbers.
+ * Time complexity: O(N^2) where N is a number of numbers.
  * Details:
- *  - Sorting takes O(NlogN) where N is a number of numbers
  *  - Finding all two sums takes N(N+1)/2 => O(N^2) where N is a number of
  * numbers
- *  - Sorting all two sums takes O(N^2logN) because there are N(N+1)/2 two sums
- * in array
- *  - Finding sums of two sums takes (N^2)log(N^2) => O((N^2)logN) where N is a
- * number of numbers
+ *  - Sorting all two sums by radix sort takes O(N^2) because there are
+ * N(N+3)/2 two sums in array
+ *  - Finding sums of two sums takes O(N^2) because every pointer passes the
+ * two sums at most once
  *
  * Space complexity: O(N^2) where N is a number of numbers because we store all
  * two sums
  */
-int FindGreatestNumber(std::vector<int> &numbers, int limit) {
+static int FindWithTwoSums(const std::vector<int> &numbers, int limit) {
   unsigned int max_sum = 0;
 
-  // Sort to break loops earlier in case we get number/sum > limit
-  sort(numbers.begin(), numbers.end());
-
   // Find all sums of two elements
   std::vector<unsigned int> two_sums;
   for (size_t i = 0; i < numbers.size(); ++i) {
@@ -51,6 +221,7 @@ int FindGreatestNumber(std::vector<int> &numbers, int limit) {
     if (max_sum < static_cast<unsigned int>(numbers[i])) {
       max_sum = numbers[i];
     }
+    two_sums.push_back(numbers[i]);
 
     for (size_t j = i; j < numbers.size(); ++j) {
       unsigned int sum = numbers[i] + numbers[j];
@@ -73,40 +244,509 @@ int FindGreatestNumber(std::vector<int> &numbers, int limit) {
     }
   }
 
-  // Sort sums to use binary search
-  sort(two_sums.begin(), two_sums.end());
+  // Sort sums for the two pointer sweep
+  std::vector<unsigned int> scratch;
+  RadixSort(two_sums, scratch);
 
-  // Sum two sums. Instead of summing all combinations,
-  // do binary search to improve performance.
-  for (size_t i = 0; i < two_sums.size(); ++i) {
-    int left = 0;
-    int right = two_sums.size() - 1;
-    while (left < right) {
-      int mid = left + (right - left) / 2;
-      unsigned int sum = two_sums[i] + two_sums[mid];
+  unsigned int sum = SweepTwoSums(two_sums.data(), two_sums.size(), limit);
+  if (max_sum < sum) {
+    max_sum = sum;
+  }
 
-      if (sum == static_cast<unsigned int>(limit)) {
-        return sum;
+  return max_sum;
+}
+
+/**
+ * Word of the bitset shifted up by r bits (r < 64), i is at least 1.
+ */
+static inline uint64_t ShiftedWord(const uint64_t *source, size_t i,
+                                   unsigned r) {
+  // Two shifts, so that r == 0 does not shift by 64
+  return (source[i] << r) | ((source[i - 1] >> 1) >> (63 - r));
+}
+
+/**
+ * Scalar kernel of ShiftOr.
+ */
+static void ShiftOrScalar(uint64_t *target, const uint64_t *source,
+                          size_t words, size_t shift) {
+  size_t q = shift / 64;
+  unsigned r = shift % 64;
+  target[q] |= source[0] << r;
+  for (size_t w = q + 1; w < words; ++w) {
+    target[w] |= ShiftedWord(source, w - q, r);
+  }
+}
+
+#if defined(__x86_64__)
+
+/**
+ * Shifts 4 words per step, shift by 64 bits gives 0 in vector shifts, so
+ * there is no special case for r == 0.
+ */
+__attribute__((target("avx2"))) static void
+ShiftOrAvx2(uint64_t *target, const uint64_t *source, size_t words,
+            size_t shift) {
+  size_t q = shift / 64;
+  unsigned r = shift % 64;
+  const __m128i up = _mm_cvtsi32_si128(r);
+  const __m128i down = _mm_cvtsi32_si128(64 - r);
+  target[q] |= source[0] << r;
+  size_t w = q + 1;
+  for (; w + 4 <= words; w += 4) {
+    const uint64_t *from = source + w - q;
+    __m256i bits = _mm256_or_si256(
+        _mm256_sll_epi64(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(from)), up),
+        _mm256_srl_epi64(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(from - 1)),
+            down));
+    __m256i *to = reinterpret_cast<__m256i *>(target + w);
+    _mm256_storeu_si256(to, _mm256_or_si256(_mm256_loadu_si256(to), bits));
+  }
+  for (; w < words; ++w) {
+    target[w] |= ShiftedWord(source, w - q, r);
+  }
+}
+
+#endif
+
+typedef void (*ShiftOrKernel)(uint64_t *, const uint64_t *, size_t, size_t);
+
+/**
+ * target |= source << shift for bitsets of the given number of words, bits
+ * shifted above the last word are dropped. The shift must be below
+ * 64 * words.
+ *
+ * The kernel is picked by cpu_huawei::simd_level().
+ *
+ * Time complexity: O(W) where W is a number of words
+ * Space complexity: O(1)
+ */
+static void ShiftOr(uint64_t *target, const uint64_t *source, size_t words,
+                    size_t shift) {
+#if defined(__x86_64__)
+  static constexpr ShiftOrKernel KERNELS[cpu_huawei::SIMD_LEVELS] = {
+      ShiftOrScalar, ShiftOrScalar, ShiftOrAvx2, ShiftOrAvx2};
+  KERNELS[static_cast<int>(cpu_huawei::simd_level())](target, source, words,
+                                                       shift);
+#else
+  ShiftOrScalar(target, source, words, shift);
+#endif
+}
+
+/**
+ * Bitset engine of FindGreatestNumber, numbers are sorted and not above the
+ * limit, the limit is not negative.
+ *
+ * Bit s of a layer is set when sum s can be picked. Layer 0 has only sum 0,
+ * layer k + 1 is layer k united with layer k shifted by every distinct
+ * number, so layer 4 has all sums of at most 4 numbers. Only words up to
+ * the limit are stored, bits of the last word above the limit are masked
+ * before the answer is read.
+ *
+ * Time complexity: O(D * L / 64) where D is a number of distinct numbers
+ * and L is the limit
+ * Space complexity: O(L / 8) bytes
+ */
+static int FindWithBitset(const int *numbers, size_t count, int limit) {
+  size_t words = static_cast<size_t>(limit) / 64 + 1;
+  size_t limit_word = static_cast<size_t>(limit) / 64;
+  uint64_t limit_bit = uint64_t(1) << (limit % 64);
+
+  std::vector<uint64_t> layer(words), next(words);
+  layer[0] = 1;
+  for (int k = 0; k < 4; ++k) {
+    next = layer;
+    for (size_t i = 0; i < count; ++i) {
+      if (numbers[i] != 0 && (i == 0 || numbers[i] != numbers[i - 1])) {
+        ShiftOr(next.data(), layer.data(), words, numbers[i]);
+      }
+    }
+    layer.swap(next);
+    // Found best max
+    if (layer[limit_word] & limit_bit) {
+      return limit;
+    }
+  }
+
+  // The greatest set bit not above the limit
+  layer[limit_word] &= limit_bit | (limit_bit - 1);
+  for (size_t w = words; w > 0; --w) {
+    if (layer[w - 1] != 0) {
+      return static_cast<int>(64 * (w - 1) + 63 -
+                              __builtin_clzll(layer[w - 1]));
+    }
+  }
+  return 0;
+}
+
+/**
+ * Estimated cost of one two sum (generating, sorting and sweeping it)
+ * relative to shifting one word of the bitset. Measured on x86-64 with
+ * AVX2 it is 20-30 for bitsets larger than the cache and up to 100 for
+ * small ones, the lower bound is taken.
+ */
+constexpr size_t TWO_SUM_COST = 20;
+
+/**
+ * Counts two sums (and single numbers) that are not above the limit, the
+ * two sums engine stores exactly that many sums. Numbers are sorted.
+ *
+ * @param ends - if not null, gets for every number i the end of the numbers
+ * that i can be paired with (pairs of i are i..ends[i] - 1)
+ *
+ * Time complexity: O(N) where N is a number of numbers
+ * Space complexity: O(1)
+ */
+static size_t CountTwoSums(const int *numbers, size_t count, int limit,
+                           size_t *ends = nullptr) {
+  size_t total = count;
+  size_t end = count;
+  for (size_t i = 0; i < count; ++i) {
+    while (end > i && numbers[i] + static_cast<long long>(numbers[end - 1]) >
+                          limit) {
+      --end;
+    }
+    total += std::max(end, i) - i;
+    if (ends != nullptr) {
+      ends[i] = std::max(end, i);
+    }
+  }
+  return total;
+}
+
+/**
+ * Counts numbers not above the limit and picks the engine for them (see
+ * FindGreatestNumber), numbers are sorted and the limit is not negative.
+ *
+ * @return true if the bitset engine is cheaper
+ */
+static bool PreferBitset(const std::vector<int> &numbers, int limit,
+                         size_t &count) {
+  count =
+      std::upper_bound(numbers.begin(), numbers.end(), limit) - numbers.begin();
+  size_t distinct = 0;
+  for (size_t i = 0; i < count; ++i) {
+    distinct += i == 0 || numbers[i] != numbers[i - 1];
+  }
+
+  size_t bitset_cost = 4 * distinct * (static_cast<size_t>(limit) / 64 + 1);
+  return bitset_cost <
+         TWO_SUM_COST * CountTwoSums(numbers.data(), count, limit);
+}
+
+/**
+ * Finds the closest to the limit sum.
+ * Can be picked at most 4 numbers (numbers can be repeated).
+ *
+ * Note: input array of numbers is modified (sorted)
+ *
+ * Two engines answer the question, the cheaper one for the input is used:
+ *  - two sums: all sums of one or two numbers are sorted and combined by a
+ *    two pointer sweep, O(N^2) time and memory
+ *  - bitset: sums of at most 4 numbers are marked in a bitset of limit
+ *    bits by 4 layers of shifts, O(D * L / 64) time and O(L / 8) memory
+ * The bitset wins when the limit is small: its shifts cost D * L / 64 word
+ * operations per layer, two sums cost the number of two sums not above the
+ * limit (counted exactly in O(N)).
+ *
+ * Time complexity: O(NlogN + min(N^2, D * L / 64)) where N is a number of
+ * numbers, D is a number of distinct numbers and L is the limit
+ * Space complexity: O(N^2) for two sums or O(L / 8) for the bitset
+ *
+ * @throws std::invalid_argument if a number is negative
+ */
+int FindGreatestNumber(std::vector<int> &numbers, int limit) {
+  // Sort to break loops earlier in case we get number/sum > limit
+  sort(numbers.begin(), numbers.end());
+  if (!numbers.empty() && numbers[0] < 0) {
+    throw std::invalid_argument("Expected non-negative number, got " +
+                                std::to_string(numbers[0]));
+  }
+  if (limit < 0) {
+    return 0;
+  }
+
+  size_t count;
+  if (PreferBitset(numbers, limit, count)) {
+    return FindWithBitset(numbers.data(), count, limit);
+  }
+  return FindWithTwoSums(numbers, limit);
+}
+
+/**
+ * Number of blocks for parallel work on n sums: blocks are not smaller than
+ * PARALLEL_MIN_BLOCK and there are a few blocks per thread to keep the pool
+ * busy when blocks are uneven.
+ */
+static size_t ParallelBlocks(size_t n, const ThreadPool &pool) {
+  return std::max<size_t>(
+      1, std::min(n / PARALLEL_MIN_BLOCK, 4 * (pool.size() + 1)));
+}
+
+/**
+ * RadixSort on the pool: every pass counts digits of blocks in parallel,
+ * offsets of every (digit, block) pair are computed in digit order, then
+ * blocks scatter their sums in parallel, so the sort stays stable.
+ *
+ * Time complexity: O(N / P) where N is a number of sums and P is a number
+ * of threads
+ * Space complexity: O(N + P) where N is a number of sums and P is a number
+ * of threads
+ */
+static void ParallelRadixSort(std::vector<unsigned int> &sums,
+                              std::vector<unsigned int> &scratch,
+                              ThreadPool &pool) {
+  size_t n = sums.size();
+  size_t blocks = ParallelBlocks(n, pool);
+  if (blocks == 1) {
+    RadixSort(sums, scratch);
+    return;
+  }
+
+  std::vector<size_t> counts(blocks * RADIX);
+  scratch.resize(n);
+  for (int pass = 0; pass < RADIX_PASSES; ++pass) {
+    int shift = pass * RADIX_BITS;
+    pool.parallel_for(blocks, [&](size_t block) {
+      size_t *count = counts.data() + block * RADIX;
+      std::fill(count, count + RADIX, 0);
+      for (size_t i = n * block / blocks; i < n * (block + 1) / blocks; ++i) {
+        ++count[(sums[i] >> shift) & (RADIX - 1)];
       }
+    });
+
+    size_t same = 0;
+    for (size_t block = 0; block < blocks; ++block) {
+      same += counts[block * RADIX + ((sums[0] >> shift) & (RADIX - 1))];
+    }
+    if (same == n) {
+      continue;
+    }
 
-      if (sum < static_cast<unsigned int>(limit)) {
-        left = mid + 1;
-      } else {
-        right = mid - 1;
+    size_t offset = 0;
+    for (size_t digit = 0; digit < RADIX; ++digit) {
+      for (size_t block = 0; block < blocks; ++block) {
+        offset += std::exchange(counts[block * RADIX + digit], offset);
       }
     }
+    pool.parallel_for(blocks, [&](size_t block) {
+      size_t *count = counts.data() + block * RADIX;
+      for (size_t i = n * block / blocks; i < n * (block + 1) / blocks; ++i) {
+        scratch[count[(sums[i] >> shift) & (RADIX - 1)]++] = sums[i];
+      }
+    });
+    sums.swap(scratch);
+  }
+}
 
-    unsigned int sum = two_sums[i] + two_sums[left];
-    if (max_sum < sum) {
-      max_sum = sum;
+/**
+ * Two sums engine on the pool, numbers[0, count) are sorted and not above
+ * the limit, the limit is not negative.
+ *
+ * Rows of the two sums (number i with numbers i.., and the number itself)
+ * are counted first, so every row knows its place in one array and blocks
+ * of rows with about the same number of sums are filled in parallel. Sum 0
+ * (nothing picked) is stored too, so single numbers and pairs need no
+ * separate maximum. The sums are sorted by ParallelRadixSort. The range of
+ * first sums of the sweep is split into blocks, every block starts its
+ * second pointer by a binary search and keeps a local best. A block that
+ * hits the limit exactly raises a flag that stops the others.
+ *
+ * Time complexity: O(N^2 / P) where N is a number of numbers and P is a
+ * number of threads
+ * Space complexity: O(N^2) where N is a number of numbers
+ */
+static int FindWithTwoSumsParallel(const int *numbers, size_t count,
+                                   int limit, ThreadPool &pool) {
+  std::vector<size_t> ends(count), rows(count + 1);
+  size_t total = 1 + CountTwoSums(numbers, count, limit, ends.data());
+  rows[0] = 1;
+  for (size_t i = 0; i < count; ++i) {
+    rows[i + 1] = rows[i] + 1 + (ends[i] - i);
+  }
+
+  std::vector<unsigned int> sums(total);
+  sums[0] = 0;
+  size_t blocks = ParallelBlocks(total, pool);
+  pool.parallel_for(blocks, [&](size_t block) {
+    // Rows that start in the block's share of the sums
+    size_t first = std::lower_bound(rows.begin(), rows.end() - 1,
+                                    total * block / blocks) -
+                   rows.begin();
+    size_t last = std::lower_bound(rows.begin(), rows.end() - 1,
+                                   total * (block + 1) / blocks) -
+                  rows.begin();
+    for (size_t i = first; i < last; ++i) {
+      unsigned int *row = sums.data() + rows[i];
+      *row++ = numbers[i];
+      for (size_t j = i; j < ends[i]; ++j) {
+        *row++ = static_cast<unsigned int>(numbers[i]) + numbers[j];
+      }
     }
+  });
 
-    if (sum > static_cast<unsigned int>(limit)) {
-      break;
+  std::vector<unsigned int> scratch;
+  ParallelRadixSort(sums, scratch, pool);
+  scratch = std::vector<unsigned int>();
+
+  unsigned int target = limit;
+  size_t half =
+      std::upper_bound(sums.begin(), sums.end(), target / 2) - sums.begin();
+  blocks = ParallelBlocks(half, pool);
+  std::vector<unsigned int> best(blocks, 0);
+  std::atomic<bool> exact(false);
+  pool.parallel_for(blocks, [&](size_t block) {
+    size_t first = half * block / blocks;
+    size_t last = half * (block + 1) / blocks;
+    size_t end = std::upper_bound(sums.begin() + first, sums.end(),
+                                  target - sums[first]) -
+                 sums.begin();
+    for (size_t i = first; i < last; ++i) {
+      if ((i - first) % PARALLEL_CHECK_PERIOD == 0 &&
+          exact.load(std::memory_order_relaxed)) {
+        return;
+      }
+      end = i + CountNotAbove(sums.data() + i, end - i, target - sums[i]);
+      best[block] = std::max(best[block], sums[i] + sums[end - 1]);
+      if (best[block] == target) {
+        exact.store(true, std::memory_order_relaxed);
+        return;
+      }
     }
+  });
+
+  if (exact.load()) {
+    return limit;
   }
+  return *std::max_element(best.begin(), best.end());
+}
 
-  return max_sum;
+/**
+ * Time complexity: O(NlogN + min(N^2 / P, D * L / 64)) where N is a number
+ * of numbers, P is a number of threads, D is a number of distinct numbers
+ * and L is the limit
+ * Space complexity: O(N^2) for two sums or O(L / 8) for the bitset
+ *
+ * @throws std::invalid_argument if a number is negative
+ */
+int FindGreatestNumberParallel(std::vector<int> &numbers, int limit,
+                               ThreadPool &pool) {
+  sort(numbers.begin(), numbers.end());
+  if (!numbers.empty() && numbers[0] < 0) {
+    throw std::invalid_argument("Expected non-negative number, got " +
+                                std::to_string(numbers[0]));
+  }
+  if (limit < 0) {
+    return 0;
+  }
+
+  size_t count;
+  if (PreferBitset(numbers, limit, count)) {
+    return FindWithBitset(numbers.data(), count, limit);
+  }
+  return FindWithTwoSumsParallel(numbers.data(), count, limit, pool);
+}
+
+/**
+ * Time complexity: O(NlogN + D^2) where N is a number of numbers and D is a
+ * number of distinct numbers
+ * Space complexity: O(D^2)
+ *
+ * @throws std::invalid_argument if a number is negative
+ */
+GreatestNumberIndex::GreatestNumberIndex(const std::vector<int> &numbers) {
+  std::vector<int> distinct = numbers;
+  sort(distinct.begin(), distinct.end());
+  distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+  if (!distinct.empty() && distinct[0] < 0) {
+    throw std::invalid_argument("Expected non-negative number, got " +
+                                std::to_string(distinct[0]));
+  }
+
+  // Sum of two numbers fits into unsigned int
+  sums.reserve(1 + distinct.size() * (distinct.size() + 3) / 2);
+  sums.push_back(0);
+  for (size_t i = 0; i < distinct.size(); ++i) {
+    sums.push_back(distinct[i]);
+    for (size_t j = i; j < distinct.size(); ++j) {
+      sums.push_back(static_cast<unsigned int>(distinct[i]) + distinct[j]);
+    }
+  }
+
+  std::vector<unsigned int> scratch;
+  RadixSort(sums, scratch);
+  sums.erase(unique(sums.begin(), sums.end()), sums.end());
+  sums.shrink_to_fit();
+}
+
+/**
+ * Time complexity: O(S) where S is a number of stored sums
+ * Space complexity: O(1)
+ */
+int GreatestNumberIndex::find(int limit) const {
+  if (limit < 0) {
+    return 0;
+  }
+  return SweepTwoSums(sums.data(), sums.size(), limit);
+}
+
+/**
+ * Answers limits in ascending order by one sweep over the stored sums, the
+ * answers are in the order of limits.
+ *
+ * Every limit has its own second pointer, placed once by a binary search
+ * and then only moved down by CountNotAbove (a scan from the top, not a
+ * search), so a limit spends O(S) on its pointer over the whole sweep. A
+ * limit is dropped from the active ones when the first sum passes its half
+ * or when it is hit exactly, the sweep ends when no limit is active.
+ *
+ * Time complexity: O(QlogQ + QlogS + Q * S) where Q is a number of limits
+ * and S is a number of stored sums
+ * Space complexity: O(Q)
+ */
+std::vector<int>
+GreatestNumberIndex::find(const std::vector<int> &limits) const {
+  std::vector<size_t> order(limits.size());
+  std::iota(order.begin(), order.end(), 0);
+  sort(order.begin(), order.end(),
+       [&](size_t a, size_t b) { return limits[a] < limits[b]; });
+
+  // Negative limits get 0, the rest are active until they are done
+  std::vector<unsigned int> sorted(order.size()), best(order.size(), 0);
+  std::vector<size_t> ends(order.size()), active;
+  for (size_t q = 0; q < order.size(); ++q) {
+    if (limits[order[q]] >= 0) {
+      sorted[q] = limits[order[q]];
+      ends[q] = std::upper_bound(sums.begin(), sums.end(), sorted[q]) -
+                sums.begin();
+      active.push_back(q);
+    }
+  }
+
+  for (size_t i = 0; i < sums.size() && !active.empty(); ++i) {
+    size_t kept = 0;
+    for (size_t q : active) {
+      if (sums[i] > sorted[q] / 2) {
+        continue;
+      }
+      // The bound only decreases as sums[i] grows, the pointer never moves up
+      ends[q] =
+          i + CountNotAbove(sums.data() + i, ends[q] - i, sorted[q] - sums[i]);
+      best[q] = std::max(best[q], sums[i] + sums[ends[q] - 1]);
+      if (best[q] != sorted[q]) {
+        active[kept++] = q;
+      }
+    }
+    active.resize(kept);
+  }
+
+  std::vector<int> result(limits.size());
+  for (size_t q = 0; q < order.size(); ++q) {
+    result[order[q]] = best[q];
+  }
+  return result;
 }
 
 } // namespace gn_huawei
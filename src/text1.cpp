@@ -1,6 +1,11 @@
+#include <array>
+#include <cstddef>
 #include <iostream>
+#include <memory_resource>
+#include <utility>
 
 #include "bigint.h"
+#include "bigint_stream.h"
 
 using namespace std::literals::string_literals;
 using std::cerr;
@@ -20,18 +25,33 @@ int ReadTestCasesCount() {
 }
 
 /**
- * Reading two BigInt numbers in the line.
+ * Reading two BigInt numbers in the line, limbs are allocated from the
+ * resource.
  */
-std::pair<BigInt, BigInt> ReadQuery() {
-  BigInt first, second;
+std::pair<BigInt, BigInt> ReadQuery(std::pmr::memory_resource *resource) {
+  BigInt first(0, resource), second(0, resource);
   cin >> first >> second;
-  return {first, second};
+  return {std::move(first), std::move(second)};
 }
 
 /**
  * Reads test cases, adds BigInts and displays results.
+ *
+ * With three arguments (text1 first second output) adds numbers from the
+ * first and the second file and writes the sum to the output file, numbers
+ * are streamed and may be larger than memory.
  */
-int main() {
+int main(int argc, char *argv[]) {
+  if (argc == 4) {
+    try {
+      add_files(argv[1], argv[2], argv[3]);
+    } catch (std::exception &err) {
+      cerr << "Addition failed: " << err.what() << endl;
+      return 1;
+    }
+    return 0;
+  }
+
   int count = ReadTestCasesCount();
   if (count <= 0) {
     cout << "Number of test cases is either zero or invalid: "s << count
@@ -39,9 +59,12 @@ int main() {
   }
 
   try {
-    std::pair<BigInt, BigInt> numbers;
+    // Numbers of a case and their sum live in the arena that is released
+    // after the case, cases that fit into the buffer never touch the heap
+    std::array<std::byte, 16384> buffer;
     for (int i = 0; i < count; ++i) {
-      const auto &[first, second] = ReadQuery();
+      std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+      const auto &[first, second] = ReadQuery(&arena);
       cout << "Case "s << i + 1 << ": "s << endl
            << first << " + "s << second << " = "s << first + second << endl
            << endl;
@@ -0,0 +1,114 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace thread_pool_huawei {
+
+/**
+ * Constructor that starts the given number of workers (at least one).
+ */
+ThreadPool::ThreadPool(size_t threads) {
+  threads = std::max<size_t>(threads, 1);
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([this]() { work(); });
+  }
+}
+
+/**
+ * Finishes queued tasks and joins workers.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  condition.notify_all();
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+      if (tasks.empty()) {
+        return;
+      }
+      task = std::move(tasks.front());
+      tasks.pop();
+    }
+    task();
+  }
+}
+
+/**
+ * Queues the task for the workers.
+ *
+ * Time complexity: O(1)
+ */
+void ThreadPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push(std::move(task));
+  }
+  condition.notify_one();
+}
+
+/**
+ * Calls body(i) for every i in [0, count) on the workers and the calling
+ * thread, returns when all calls are finished.
+ *
+ * Time complexity: O(count / threads) calls of body per thread
+ */
+void ThreadPool::parallel_for(size_t count,
+                              const std::function<void(size_t)> &body) {
+  if (count == 0) {
+    return;
+  }
+  // Helpers may start after the loop is over, the state outlives the call
+  struct Loop {
+    std::atomic<size_t> next{0};
+    size_t done = 0;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+  auto loop = std::make_shared<Loop>();
+  auto run = [loop, count, &body]() {
+    size_t completed = 0;
+    for (size_t i = loop->next++; i < count; i = loop->next++) {
+      body(i);
+      ++completed;
+    }
+    if (completed > 0) {
+      std::lock_guard<std::mutex> lock(loop->mutex);
+      loop->done += completed;
+      if (loop->done == count) {
+        loop->finished.notify_all();
+      }
+    }
+  };
+
+  size_t helpers = std::min(count, workers.size() + 1) - 1;
+  for (size_t i = 0; i < helpers; ++i) {
+    submit(run);
+  }
+  run();
+
+  std::unique_lock<std::mutex> lock(loop->mutex);
+  loop->finished.wait(lock, [&]() { return loop->done == count; });
+}
+
+/**
+ * Pool shared by the whole program, a worker per hardware thread.
+ */
+ThreadPool &ThreadPool::shared() {
+  static ThreadPool pool(std::thread::hardware_concurrency());
+  return pool;
+}
+
+} // namespace thread_pool_huawei
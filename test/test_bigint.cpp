@@ -1,13 +1,32 @@
+#include <algorithm>
+#include <array>
 #include <assert.h>
 #include <climits>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iomanip>
+#include <memory_resource>
 #include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 #include "bigint.h"
+#include "bigint_accumulator.h"
+#include "bigint_limbs.h"
+#include "bigint_stream.h"
+#include "bigint_tree.h"
+#include "bigint_view.h"
+#include "cpu_features.h"
+#include "fixed_bigint.h"
+#include "thread_pool.h"
 
-#define NUM_TESTS 6
+#define NUM_TESTS 24
 
 using namespace std::literals::string_literals;
 using std::cout;
@@ -104,6 +123,871 @@ void TestAdditionOperation() {
   assert(((a + b).to_string() == "1111111111111111110"s));
 }
 
+void TestAdditionAcrossLimbs() {
+  cout << "TestAdditionAcrossLimbs"s << endl;
+
+  BigInt limb_max("999999999"s);
+  BigInt one(1);
+  assert(((limb_max + one).to_string() == "1000000000"s));
+
+  BigInt carry_chain(string(45, '9'));
+  assert(((carry_chain + one).to_string() == "1"s + string(45, '0')));
+  assert(((one + carry_chain).to_string() == "1"s + string(45, '0')));
+
+  BigInt padded("000000000000123000000000000000000456"s);
+  assert((padded.to_string() == "123000000000000000000456"s));
+  assert(((padded + padded).to_string() == "246000000000000000000912"s));
+
+  BigInt long_number(1000000000000000000LL);
+  assert((long_number.to_string() == "1000000000000000000"s));
+}
+
+/**
+ * Compares vectorized limb addition with the scalar one.
+ * Limbs are picked from the values around BASE - 1 to get long carry chains.
+ */
+void TestVectorizedLimbAddition() {
+  cout << "TestVectorizedLimbAddition"s << endl;
+
+  std::mt19937 generator(2024);
+  std::uniform_int_distribution<int> distribution_kind(0, 3);
+  std::uniform_int_distribution<uint32_t> distribution_limb(0,
+                                                            BigInt::BASE - 1);
+  auto random_limb = [&]() -> uint32_t {
+    switch (distribution_kind(generator)) {
+    case 0:
+      return 0;
+    case 1:
+      return BigInt::BASE - 1;
+    case 2:
+      return BigInt::BASE / 2;
+    default:
+      return distribution_limb(generator);
+    }
+  };
+
+  for (size_t n = 0; n < 100; ++n) {
+    std::vector<uint32_t> a(n), b(n), expected(n), actual(n);
+    for (size_t i = 0; i < n; ++i) {
+      a[i] = random_limb();
+      b[i] = random_limb();
+    }
+    for (uint32_t carry = 0; carry <= 1; ++carry) {
+      uint32_t expected_carry = limbs::add_n_scalar(
+          a.data(), b.data(), expected.data(), n, carry);
+      uint32_t actual_carry =
+          limbs::add_n(a.data(), b.data(), actual.data(), n, carry);
+      assert((expected_carry == actual_carry));
+      assert((expected == actual));
+    }
+  }
+
+  BigInt all_nines(string(100, '9'));
+  BigInt one(1);
+  assert(((all_nines + one).to_string() == "1"s + string(100, '0')));
+}
+
+void TestCpuDispatch() {
+  cout << "TestCpuDispatch"s << endl;
+
+  using cpu_huawei::SimdLevel;
+  SimdLevel detected = cpu_huawei::detected_simd_level();
+  SimdLevel initial = cpu_huawei::simd_level();
+  assert((static_cast<int>(initial) <= static_cast<int>(detected)));
+  assert((cpu_huawei::set_simd_level(SimdLevel::avx512) == detected));
+  assert((cpu_huawei::set_simd_level(SimdLevel::scalar) == SimdLevel::scalar));
+
+  std::mt19937 generator(20);
+  std::uniform_int_distribution<uint32_t> distribution_limb(0,
+                                                            BigInt::BASE - 1);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  std::vector<std::vector<uint32_t>> a, b;
+  std::vector<string> digits;
+  for (size_t n = 0; n < 80; ++n) {
+    a.emplace_back(n);
+    b.emplace_back(n);
+    for (size_t i = 0; i < n; ++i) {
+      // Runs of BASE - 1 propagate carries through whole vectors
+      a[n][i] = n % 3 == 0 ? BigInt::BASE - 1 : distribution_limb(generator);
+      b[n][i] = n % 3 == 0 ? n % 2 : distribution_limb(generator);
+    }
+    digits.emplace_back(4 * n, '0');
+    for (char &digit : digits.back()) {
+      digit += distribution_digit(generator);
+    }
+  }
+
+  // Every level must give the same results as the scalar one
+  auto run_kernels = [&]() {
+    std::vector<uint32_t> results;
+    for (size_t n = 0; n < a.size(); ++n) {
+      std::vector<uint32_t> sum(n);
+      results.push_back(
+          limbs::add_n(a[n].data(), b[n].data(), sum.data(), n, n % 2));
+      results.insert(results.end(), sum.begin(), sum.end());
+
+      std::vector<uint64_t> wide(n, BigInt::BASE);
+      limbs::add_wide(wide.data(), a[n].data(), n);
+      results.insert(results.end(), wide.begin(), wide.end());
+
+      std::vector<uint32_t> parsed((digits[n].size() + 8) / 9);
+      results.push_back(
+          limbs::parse_decimal(digits[n].data(), digits[n].size(),
+                               parsed.data()));
+      results.insert(results.end(), parsed.begin(), parsed.end());
+
+      // A wrong character in any position of a limb must be noticed
+      string wrong = digits[n];
+      if (!wrong.empty()) {
+        wrong[n * 7 % wrong.size()] = n % 2 ? '/' : ':';
+        results.push_back(
+            limbs::parse_decimal(wrong.data(), wrong.size(), parsed.data()));
+        assert((results.back() == 0));
+      }
+    }
+    return results;
+  };
+  std::vector<uint32_t> expected = run_kernels();
+  for (int level = 1; level <= static_cast<int>(detected); ++level) {
+    cpu_huawei::set_simd_level(static_cast<SimdLevel>(level));
+    assert((run_kernels() == expected));
+  }
+  cpu_huawei::set_simd_level(initial);
+}
+
+void TestParallelAddition() {
+  cout << "TestParallelAddition"s << endl;
+
+  thread_pool_huawei::ThreadPool pool(4);
+  std::mt19937 generator(2025);
+  std::uniform_int_distribution<uint32_t> distribution_limb(0,
+                                                            BigInt::BASE - 1);
+
+  // Long runs of BASE - 1 make carries cross many blocks
+  for (size_t n : {1, 63, 64, 1000, 4099}) {
+    for (int kind = 0; kind < 3; ++kind) {
+      std::vector<uint32_t> a(n), b(n), expected(n), actual(n);
+      for (size_t i = 0; i < n; ++i) {
+        a[i] = kind == 0 ? distribution_limb(generator) : BigInt::BASE - 1;
+        b[i] = kind == 2 && i > 0 ? 0 : distribution_limb(generator);
+      }
+      for (uint32_t carry = 0; carry <= 1; ++carry) {
+        uint32_t expected_carry =
+            limbs::add_n(a.data(), b.data(), expected.data(), n, carry);
+        uint32_t actual_carry = limbs::add_n_parallel(
+            a.data(), b.data(), actual.data(), n, carry, pool, 16);
+        assert((expected_carry == actual_carry));
+        assert((expected == actual));
+      }
+    }
+  }
+
+  std::vector<uint32_t> nines(5000, BigInt::BASE - 1), zeros(5000, 0);
+  assert((limbs::add_n_parallel(nines.data(), zeros.data(), zeros.data(),
+                                5000, 1, pool, 16) == 1));
+  assert((std::count(zeros.begin(), zeros.end(), 0u) == 5000));
+}
+
+void TestInPlaceAndMoveAddition() {
+  cout << "TestInPlaceAndMoveAddition"s << endl;
+
+  BigInt sum;
+  sum += BigInt(999999999);
+  assert((sum.to_string() == "999999999"s));
+  sum += BigInt(1);
+  assert((sum.to_string() == "1000000000"s));
+
+  BigInt short_number(5);
+  short_number += BigInt(string(30, '9'));
+  assert((short_number.to_string() == "1"s + string(29, '0') + "4"s));
+
+  sum += sum;
+  assert((sum.to_string() == "2000000000"s));
+
+  BigInt a("123456789123456789"s);
+  BigInt b("876543210876543211"s);
+  string expected = "1000000000000000000"s;
+  assert(((BigInt(a) + b).to_string() == expected));
+  assert(((a + BigInt(b)).to_string() == expected));
+  assert(((BigInt(a) + BigInt(b)).to_string() == expected));
+  assert(((a + b).to_string() == expected));
+
+  // Running sum of 1000 equal numbers matches the multiplication by hand
+  BigInt running;
+  BigInt term(string(50, '7'));
+  for (int i = 0; i < 1000; ++i) {
+    running = std::move(running) + term;
+  }
+  assert((running.to_string() == string(50, '7') + "000"s));
+
+  BigInt check;
+  for (int i = 0; i < 1000; ++i) {
+    check += term;
+  }
+  assert((check.to_string() == running.to_string()));
+}
+
+void TestSmallNumbersBoundary() {
+  cout << "TestSmallNumbersBoundary"s << endl;
+
+  string max_small(BigInt::SMALL_DIGITS, '9');
+  string min_large = "1"s + string(BigInt::SMALL_DIGITS, '0');
+
+  BigInt a(max_small);
+  assert((a.to_string() == max_small));
+  assert(((a + BigInt(1)).to_string() == min_large));
+  assert(((BigInt(1) + a).to_string() == min_large));
+  assert(((a + a).to_string() == "1"s + string(BigInt::SMALL_DIGITS - 1, '9') +
+                                     "8"s));
+
+  BigInt b(max_small);
+  b += BigInt(1);
+  assert((b.to_string() == min_large));
+  b += b;
+  assert((b.to_string() == "2"s + string(BigInt::SMALL_DIGITS, '0')));
+
+  BigInt large(min_large);
+  assert((large.to_string() == min_large));
+  BigInt small(LLONG_MAX);
+  assert((small.to_string() == std::to_string(LLONG_MAX)));
+  assert(((small + large).to_string() ==
+          "1"s + string(BigInt::SMALL_DIGITS - 19, '0') +
+              std::to_string(LLONG_MAX)));
+  assert(((large + small).to_string() == (small + large).to_string()));
+
+  small += large;
+  assert((small.to_string() == (large + BigInt(LLONG_MAX)).to_string()));
+
+  // 45 digits take as many limbs as the inline numbers
+  BigInt five_limbs("100000000000000000000000000000000000000000000"s);
+  five_limbs += BigInt(7);
+  assert((five_limbs.to_string() ==
+          "100000000000000000000000000000000000000000007"s));
+
+  // 20 digits do not fit 64 bits but are still inline
+  BigInt twenty_digits("12345678901234567890"s);
+  assert(((twenty_digits + twenty_digits).to_string() ==
+          "24691357802469135780"s));
+}
+
+void TestParseAndFormat() {
+  cout << "TestParseAndFormat"s << endl;
+
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  for (size_t len = 1; len < 200; ++len) {
+    string digits(len, '0');
+    for (char &digit : digits) {
+      digit = '0' + distribution_digit(generator);
+    }
+    digits[0] = '1' + distribution_digit(generator) % 9;
+
+    BigInt number(digits);
+    assert((number.to_string() == digits));
+
+    std::ostringstream out;
+    out << number;
+    assert((out.str() == digits));
+
+    // characters right before '0' and after '9' are rejected everywhere
+    for (char bad : {'/', ':', ' ', '\xff'}) {
+      string bad_digits = digits;
+      size_t pos = generator() % len;
+      bad_digits[pos] = bad;
+      bool thrown = false;
+      try {
+        BigInt bad_number(bad_digits);
+      } catch (std::invalid_argument &e) {
+        string expected_message = "Expected positive integer, got "s +
+                                  bad_digits + " (-->'"s + bad + "')"s;
+        assert(e.what() == expected_message);
+        thrown = true;
+      }
+      assert(thrown);
+    }
+  }
+
+  // string_view of a part of the line
+  string line = "12345678901234567890123456789012345678901234567890 tail"s;
+  std::string_view view(line);
+  BigInt from_view(view.substr(0, 50));
+  assert((from_view.to_string() == line.substr(0, 50)));
+  BigInt from_literal("000042");
+  assert((from_literal.to_string() == "42"s));
+
+  // width and fill of the stream are respected
+  std::ostringstream padded;
+  padded << std::setw(5) << std::setfill('*') << BigInt(42) << BigInt(7);
+  assert((padded.str() == "***427"s));
+
+  std::ostringstream zero;
+  zero << BigInt();
+  assert((zero.str() == "0"s));
+}
+
+/**
+ * Checks multiplication on sizes from schoolbook to NTT:
+ * (10^n - 1)^2 = 9..98 0..01 and a * (b + c) == a * b + a * c.
+ */
+void TestMultiplication() {
+  cout << "TestMultiplication"s << endl;
+
+  assert(((BigInt(0) * BigInt(12345)).to_string() == "0"s));
+  assert(((BigInt(12345) * BigInt(1)).to_string() == "12345"s));
+  assert(((BigInt(99999) * BigInt(99999)).to_string() == "9999800001"s));
+  assert(((BigInt(LLONG_MAX) * BigInt(LLONG_MAX)).to_string() ==
+          "85070591730234615847396907784232501249"s));
+
+  BigInt product(2);
+  product *= BigInt(string(40, '5'));
+  assert((product.to_string() == "1"s + string(39, '1') + "0"s));
+
+  for (size_t n : {1, 9, 20, 100, 300, 1000, 3000, 10000, 40000}) {
+    BigInt nines(string(n, '9'));
+    assert(((nines * nines).to_string() ==
+            string(n - 1, '9') + "8"s + string(n - 1, '0') + "1"s));
+  }
+
+  std::mt19937 generator(11);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  auto random_number = [&](size_t len) {
+    string digits(len, '0');
+    for (char &digit : digits) {
+      digit = '0' + distribution_digit(generator);
+    }
+    return BigInt(digits);
+  };
+  for (size_t n : {5, 50, 400, 2500, 6000, 30000}) {
+    BigInt a = random_number(n);
+    BigInt b = random_number(n * 2 / 3 + 1);
+    BigInt c = random_number(n / 4 + 1);
+    assert(((a * b).to_string() == (b * a).to_string()));
+    assert(((a * (b + c)).to_string() == (a * b + a * c).to_string()));
+  }
+}
+
+void TestDivision() {
+  cout << "TestDivision"s << endl;
+
+  assert(((BigInt(100) / BigInt(7)).to_string() == "14"s));
+  assert(((BigInt(100) % BigInt(7)).to_string() == "2"s));
+  assert(((BigInt(5) / BigInt(12345)).to_string() == "0"s));
+  assert(((BigInt(5) % BigInt(12345)).to_string() == "5"s));
+  assert((BigInt(12345) < BigInt(string(40, '1'))));
+  assert((BigInt(string(40, '1')) == BigInt(string(40, '1'))));
+
+  bool thrown = false;
+  try {
+    BigInt(1) / BigInt(0);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  // 10^n - 1 = (10^k - 1) * (10^(n-k) + 10^(n-2k) + ... ) when k divides n
+  for (size_t n : {60, 900, 12000, 36000}) {
+    size_t k = n / 3;
+    auto [quotient, remainder] =
+        divmod(BigInt(string(n, '9')), BigInt(string(k, '9')));
+    string expected = "1"s + string(k - 1, '0') + "1"s + string(k - 1, '0') +
+                      "1"s;
+    assert((quotient.to_string() == expected));
+    assert((remainder.to_string() == "0"s));
+  }
+
+  std::mt19937 generator(13);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  auto random_number = [&](size_t len) {
+    string digits(len, '0');
+    for (char &digit : digits) {
+      digit = '0' + distribution_digit(generator);
+    }
+    digits[0] = '1' + distribution_digit(generator) % 9;
+    return BigInt(digits);
+  };
+  for (auto [n, m] : std::vector<std::pair<size_t, size_t>>{
+           {40, 10}, {100, 39}, {500, 200}, {5000, 300}, {20000, 8000},
+           {60000, 25000}}) {
+    BigInt a = random_number(n);
+    BigInt b = random_number(m);
+    auto [quotient, remainder] = divmod(a, b);
+    assert((remainder < b));
+    assert(((quotient * b + remainder) == a));
+    assert(((a * b + remainder) / b == a));
+  }
+}
+
+void TestPower() {
+  cout << "TestPower"s << endl;
+
+  assert((pow(BigInt(2), 0).to_string() == "1"s));
+  assert((pow(BigInt(0), 5).to_string() == "0"s));
+  assert((pow(BigInt(2), 100).to_string() ==
+          "1267650600228229401496703205376"s));
+  assert((pow(BigInt(10), 90).to_string() == "1"s + string(90, '0')));
+
+  assert((powmod(BigInt(4), BigInt(13), BigInt(497)).to_string() == "445"s));
+  assert((powmod(BigInt(12345), BigInt(0), BigInt(7)).to_string() == "1"s));
+  assert((powmod(BigInt(12345), BigInt(678), BigInt(1)).to_string() == "0"s));
+
+  bool thrown = false;
+  try {
+    powmod(BigInt(2), BigInt(3), BigInt(0));
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  // Fermat's little theorem for the Mersenne prime 2^127 - 1
+  BigInt prime("170141183460469231731687303715884105727"s);
+  BigInt prime_minus_one("170141183460469231731687303715884105726"s);
+  for (long long base : {2, 3, 1000000007}) {
+    assert((powmod(BigInt(base), prime_minus_one, prime).to_string() ==
+            "1"s));
+  }
+
+  // Both reductions (odd modulus - Montgomery, even one - Barrett) agree
+  // with the plain power
+  BigInt base("98765432109876543210987654321"s);
+  BigInt power = pow(base, 250);
+  for (const char *modulus : {"1000000000000000000000000000000000000000007",
+                              "12345678901234567890123456789012345678901234567"
+                              "89012345678901234567890123456789012345678901",
+                              "10000000000000000000000000000000000000000000000"
+                              "000000",
+                              "55555555555555555555555555555555555555555555"}) {
+    assert((powmod(base, BigInt(250), BigInt(modulus)) ==
+            power % BigInt(modulus)));
+  }
+}
+
+void TestGcd() {
+  cout << "TestGcd"s << endl;
+
+  assert((gcd(BigInt(), BigInt()) == BigInt()));
+  assert((gcd(BigInt(12), BigInt()) == BigInt(12)));
+  assert((gcd(BigInt(12), BigInt(18)) == BigInt(6)));
+  assert((lcm(BigInt(12), BigInt(18)) == BigInt(36)));
+  assert((lcm(BigInt(), BigInt(18)) == BigInt()));
+  assert((modinv(BigInt(3), BigInt(11)) == BigInt(4)));
+  assert((modinv(BigInt(25), BigInt(11)) == BigInt(4)));
+  assert((modinv(BigInt(5), BigInt(1)) == BigInt()));
+
+  auto throws = [](const BigInt &number, const BigInt &modulus) {
+    try {
+      modinv(number, modulus);
+    } catch (const std::invalid_argument &) {
+      return true;
+    }
+    return false;
+  };
+  assert(throws(BigInt(6), BigInt(9)));
+  assert(throws(BigInt(6), BigInt()));
+  assert(throws(BigInt(), BigInt(7)));
+
+  // Consecutive Fibonacci numbers have all quotients 1
+  BigInt previous(1), current(1);
+  for (int i = 0; i < 20000; ++i) {
+    BigInt next = previous + current;
+    previous = std::move(current);
+    current = std::move(next);
+  }
+  assert((gcd(current, previous) == BigInt(1)));
+  assert((modinv(previous, current) * previous % current == BigInt(1)));
+
+  // Random numbers with a common divisor, sizes cross the half-GCD threshold
+  std::mt19937 generator(3);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  auto random_number = [&](size_t length) {
+    string number(length, '0');
+    for (char &digit : number) {
+      digit = '0' + distribution_digit(generator);
+    }
+    number[0] = '1';
+    return BigInt(number);
+  };
+  for (size_t length : {5, 30, 200, 1500, 6000}) {
+    BigInt divisor = random_number(length / 2 + 1);
+    BigInt a = random_number(length), b = random_number(length + 7);
+    BigInt common = gcd(a, b);
+    assert((a % common == BigInt() && b % common == BigInt()));
+    assert((gcd(a / common, b / common) == BigInt(1)));
+    BigInt with_divisor = gcd(a * divisor, b * divisor);
+    assert((with_divisor == common * divisor));
+    assert((lcm(a, b) == a / common * b));
+
+    BigInt number = a / common, modulus = b / common;
+    BigInt inverse = modinv(number, modulus);
+    assert((inverse < modulus &&
+            number * inverse % modulus == BigInt(1) % modulus));
+  }
+}
+
+void TestHexAndBytes() {
+  cout << "TestHexAndBytes"s << endl;
+
+  assert((BigInt(0).to_hex() == "0"s));
+  assert((BigInt(255).to_hex() == "ff"s));
+  assert((BigInt::from_hex("DeadBeef"s).to_string() == "3735928559"s));
+  assert((BigInt::from_hex("000"s).to_string() == "0"s));
+  assert((pow(BigInt(2), 100).to_hex() == "1"s + string(25, '0')));
+  assert((pow(BigInt(16), 3000).to_hex() == "1"s + string(3000, '0')));
+  assert((BigInt::from_hex(string(2000, 'f')) + BigInt(1) ==
+          pow(BigInt(16), 2000)));
+
+  bool thrown = false;
+  try {
+    BigInt::from_hex("12g4"s);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  assert((BigInt(0).to_bytes().empty()));
+  assert((BigInt(258).to_bytes() == std::vector<uint8_t>{1, 2}));
+  const uint8_t bytes[] = {0, 0, 1, 0, 0, 0, 0};
+  assert((BigInt::from_bytes(bytes, sizeof(bytes)).to_string() ==
+          "4294967296"s));
+
+  // Long numbers are split by powers of 2^32 in both directions
+  for (uint64_t exponent : {100, 5000, 60000}) {
+    BigInt number = pow(BigInt(3), exponent);
+    assert((BigInt::from_hex(number.to_hex()) == number));
+    std::vector<uint8_t> number_bytes = number.to_bytes();
+    assert((BigInt::from_bytes(number_bytes.data(), number_bytes.size()) ==
+            number));
+  }
+}
+
+void TestAccumulator() {
+  cout << "TestAccumulator"s << endl;
+
+  BigIntAccumulator accumulator;
+  assert((accumulator.finish().to_string() == "0"s));
+
+  // Small numbers only: the uint128 sum goes above 10^38
+  for (int i = 0; i < 20; ++i) {
+    accumulator += BigInt(string(19, '9'));
+  }
+  assert((accumulator.finish().to_string() == "1"s + string(18, '9') + "80"s));
+
+  // Mixed lengths, limbs stay unnormalized until finish()
+  BigInt expected;
+  std::mt19937 generator(17);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  std::uniform_int_distribution<size_t> distribution_length(1, 300);
+  for (int i = 0; i < 5000; ++i) {
+    string digits(distribution_length(generator), '9');
+    if (i % 3 != 0) {
+      for (char &digit : digits) {
+        digit = '0' + distribution_digit(generator);
+      }
+    }
+    BigInt number(digits);
+    accumulator += number;
+    expected += number;
+  }
+  assert((accumulator.finish() == expected));
+  assert((accumulator.finish().to_string() == "0"s));
+}
+
+void TestProductAndSumTree() {
+  cout << "TestProductAndSumTree"s << endl;
+
+  thread_pool_huawei::ThreadPool pool(3);
+  assert((product_tree({}, pool) == BigInt(1)));
+  assert((sum_tree({}, pool) == BigInt()));
+  assert((product_tree({BigInt(7)}, pool) == BigInt(7)));
+
+  std::vector<BigInt> numbers;
+  BigInt factorial(1), sum;
+  for (int i = 1; i <= 3000; ++i) {
+    numbers.emplace_back(i);
+    factorial *= BigInt(i);
+  }
+  assert((product_tree(numbers, pool) == factorial));
+  assert((product_tree(numbers) == factorial));
+
+  std::mt19937 generator(5);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  std::uniform_int_distribution<int> distribution_length(1, 300);
+  numbers.clear();
+  for (int i = 0; i < 2000; ++i) {
+    string number(distribution_length(generator), '0');
+    for (char &digit : number) {
+      digit = '0' + distribution_digit(generator);
+    }
+    numbers.emplace_back(number);
+    sum += numbers.back();
+  }
+  assert((sum_tree(numbers, pool) == sum));
+  assert((sum_tree(numbers) == sum));
+  numbers.resize(5);
+  assert((sum_tree(numbers, pool) ==
+          numbers[0] + numbers[1] + numbers[2] + numbers[3] + numbers[4]));
+}
+
+void TestMemoryResource() {
+  cout << "TestMemoryResource"s << endl;
+
+  // Any allocation past the buffer throws std::bad_alloc
+  std::array<std::byte, 4096> buffer;
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(),
+                                            std::pmr::null_memory_resource());
+
+  string digits(200, '7');
+  BigInt first(digits, &arena), second(0, &arena);
+  std::istringstream in(string(150, '2'));
+  in >> second;
+  BigInt sum = first + second;
+  assert((first.resource() == &arena && second.resource() == &arena &&
+          sum.resource() == &arena));
+  assert((sum == BigInt(string(50, '7') + string(150, '9'))));
+  sum += first;
+  assert((sum.resource() == &arena));
+
+  // Two inline numbers that spill to limbs
+  BigInt small_first(string(38, '9'), &arena),
+      small_second(string(38, '9'), &arena);
+  BigInt small_sum = small_first + small_second;
+  assert((small_sum.resource() == &arena));
+  assert((small_sum == BigInt("1"s + string(37, '9') + "8"s)));
+
+  BigInt copy(sum);
+  assert((copy == sum && copy.resource() == std::pmr::get_default_resource()));
+  assert((BigInt().resource() == std::pmr::get_default_resource()));
+
+  bool thrown = false;
+  try {
+    BigInt(string(100000, '1'), &arena);
+  } catch (const std::bad_alloc &) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+void TestBinaryFormat() {
+  cout << "TestBinaryFormat"s << endl;
+
+  std::mt19937 generator(11);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  std::vector<BigInt> numbers = {BigInt(), BigInt(1), BigInt(string(38, '9')),
+                            BigInt("1"s + string(38, '0'))};
+  for (size_t length : {5, 40, 1000, 20000}) {
+    string number(length, '0');
+    for (char &digit : number) {
+      digit = '0' + distribution_digit(generator);
+    }
+    number[0] = '1';
+    numbers.emplace_back(number);
+  }
+
+  std::stringstream stream;
+  for (const BigInt &number : numbers) {
+    number.write_binary(stream);
+  }
+  string bytes = stream.str();
+  for (const BigInt &number : numbers) {
+    assert((BigInt::read_binary(stream) == number));
+  }
+
+  // Views over one aligned buffer with all numbers one after another
+  std::vector<uint32_t> buffer(bytes.size() / sizeof(uint32_t));
+  std::memcpy(buffer.data(), bytes.data(), bytes.size());
+  const char *position = reinterpret_cast<const char *>(buffer.data());
+  size_t left = bytes.size();
+  std::vector<BigIntView> views;
+  for (const BigInt &number : numbers) {
+    views.push_back(BigIntView::from_buffer(position, left));
+    assert((views.back().to_bigint() == number));
+    position += views.back().binary_size();
+    left -= views.back().binary_size();
+  }
+  assert((left == 0));
+  for (size_t i = 0; i < numbers.size(); ++i) {
+    for (size_t j = 0; j < numbers.size(); ++j) {
+      BigInt expected = numbers[i] + numbers[j];
+      assert((views[i] + views[j] == expected));
+      assert((views[i] + numbers[j] == expected));
+      assert((numbers[i] + views[j] == expected));
+    }
+  }
+
+  auto throws = [](const string &data, bool view) {
+    std::vector<uint32_t> aligned(data.size() / sizeof(uint32_t) + 1);
+    std::memcpy(aligned.data(), data.data(), data.size());
+    std::istringstream in(data);
+    try {
+      if (view) {
+        BigIntView::from_buffer(aligned.data(), data.size());
+      } else {
+        BigInt::read_binary(in);
+      }
+    } catch (const std::invalid_argument &) {
+      return true;
+    } catch (const std::runtime_error &) {
+      return !view;
+    }
+    return false;
+  };
+  std::stringstream one;
+  BigInt(123456789012ll).write_binary(one);
+  string valid = one.str();
+  for (bool view : {false, true}) {
+    assert((!throws(valid, view)));
+    assert((throws(valid.substr(0, valid.size() - 1), view)));
+    assert((throws(valid.substr(0, 10), view)));
+    string corrupted = valid;
+    corrupted[0] = 'X';
+    assert((throws(corrupted, view)));
+    corrupted = valid;
+    corrupted[4] = 2; // version
+    assert((throws(corrupted, view)));
+    corrupted = valid;
+    corrupted[BINARY_HEADER_SIZE + 4 + 3] = char(0xff); // limb above the base
+    assert((throws(corrupted, view)));
+  }
+}
+
+void TestFixedBigInt() {
+  cout << "TestFixedBigInt"s << endl;
+
+  using Fixed128 = FixedBigInt<128>;
+  using Fixed256 = FixedBigInt<256>;
+
+  // Evaluated by the compiler
+  constexpr Fixed128 MAX_128("340282366920938463463374607431768211455");
+  static_assert(MAX_128.limb(0) == ~0ull && MAX_128.limb(1) == ~0ull);
+  static_assert(MAX_128 + 1 == 0);
+  static_assert(Fixed128(0) - 1 == MAX_128);
+  static_assert(MAX_128 * MAX_128 == 1);
+  static_assert(Fixed128(10000000000000000000ull) * 10 ==
+                Fixed128("100000000000000000000"));
+  static_assert(Fixed128(5) < Fixed128("18446744073709551616"));
+  static_assert(!(MAX_128 < MAX_128) && MAX_128 >= MAX_128);
+
+  assert((MAX_128.to_string() == "340282366920938463463374607431768211455"s));
+  assert((Fixed256().to_string() == "0"s));
+  assert((Fixed256("000123").to_string() == "123"s));
+  assert((Fixed256(BigInt()) == 0));
+
+  bool thrown = false;
+  try {
+    Fixed128("340282366920938463463374607431768211456");
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+  thrown = false;
+  try {
+    Fixed128("12a");
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+  thrown = false;
+  try {
+    Fixed128(BigInt("340282366920938463463374607431768211456"));
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  // Compared with BigInt modulo 2^256
+  BigInt modulus = pow(BigInt(2), 256);
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  std::uniform_int_distribution<int> distribution_length(1, 77);
+  for (int i = 0; i < 200; ++i) {
+    string digits[2];
+    for (string &number : digits) {
+      number.assign(distribution_length(generator), '0');
+      for (char &digit : number) {
+        digit = '0' + distribution_digit(generator);
+      }
+    }
+    BigInt a = BigInt(digits[0]) % modulus, b = BigInt(digits[1]) % modulus;
+    Fixed256 x(a), y(b);
+    assert((x.to_bigint() == a && x.to_string() == a.to_string()));
+    assert(((x + y).to_bigint() == (a + b) % modulus));
+    assert(((x * y).to_bigint() == a * b % modulus));
+    assert((((x - y).to_bigint() + b) % modulus == a));
+    assert(((x < y) == (a < b) && (x == y) == (a == b)));
+    assert((Fixed256(a.to_string()) == x));
+  }
+}
+
+void TestStreamingAddition() {
+  cout << "TestStreamingAddition"s << endl;
+
+  std::filesystem::path directory = std::filesystem::temp_directory_path();
+  string first_path = (directory / "bigint_first.txt").string();
+  string second_path = (directory / "bigint_second.txt").string();
+  string output_path = (directory / "bigint_sum.txt").string();
+  auto add = [&](const string &first, const string &second) {
+    std::ofstream(first_path) << first;
+    std::ofstream(second_path) << second;
+    // Tiny chunks make carries cross chunk boundaries
+    add_files(first_path, second_path, output_path, 7);
+    std::ifstream output(output_path);
+    return string(std::istreambuf_iterator<char>(output), {});
+  };
+
+  assert((add("0"s, "0\n"s) == "0\n"s));
+  assert((add("  00123 \n"s, "877"s) == "1000\n"s));
+  assert((add(string(100, '9'), "1"s) == "1"s + string(100, '0') + "\n"s));
+  assert((add("6"s, string(30, '9') + "4"s) == "1"s + string(31, '0') + "\n"s));
+
+  std::mt19937 generator(19);
+  std::uniform_int_distribution<int> distribution_digit(0, 9);
+  for (size_t length : {10, 99, 1000}) {
+    string first(length, '0'), second(length / 3 + 1, '0');
+    for (char &digit : first) {
+      digit = '0' + distribution_digit(generator);
+    }
+    for (char &digit : second) {
+      digit = '0' + distribution_digit(generator);
+    }
+    string expected = (BigInt(first) + BigInt(second)).to_string() + "\n"s;
+    assert((add(first, second) == expected));
+    assert((add(second, first) == expected));
+  }
+
+  bool thrown = false;
+  try {
+    add("12a4"s, "1"s);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+  assert((!std::filesystem::exists(output_path)));
+
+  // The output must not overwrite an input, chunks must not be empty
+  std::ofstream(first_path) << "123"s;
+  std::ofstream(second_path) << "456"s;
+  for (const string &output : {first_path, second_path}) {
+    thrown = false;
+    try {
+      add_files(first_path, second_path, output);
+    } catch (const std::invalid_argument &) {
+      thrown = true;
+    }
+    assert(thrown);
+  }
+  thrown = false;
+  try {
+    add_files(first_path, second_path, output_path, 0);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+  std::ifstream first_file(first_path);
+  assert((string(std::istreambuf_iterator<char>(first_file), {}) == "123"s));
+
+  std::filesystem::remove(first_path);
+  std::filesystem::remove(second_path);
+}
+
 void TestRandomNumbersAddition() {
   cout << "TestRandomNumbersAddition"s << endl;
 
@@ -137,9 +1021,18 @@ void TestAdditionOperationTime() {
 
 typedef void (*PROC)(void);
 const PROC tests[NUM_TESTS] = {
-    &TestDefaultConstructor,    &TestUnsignedLongLongConstructor,
-    &TestStringConstructor,     &TestAdditionOperation,
-    &TestRandomNumbersAddition, &TestAdditionOperationTime,
+    &TestDefaultConstructor,      &TestUnsignedLongLongConstructor,
+    &TestStringConstructor,       &TestAdditionOperation,
+    &TestAdditionAcrossLimbs,     &TestVectorizedLimbAddition,
+    &TestCpuDispatch,             &TestParallelAddition,
+    &TestInPlaceAndMoveAddition,  &TestSmallNumbersBoundary,
+    &TestParseAndFormat,          &TestMultiplication,
+    &TestDivision,                &TestPower,
+    &TestGcd,                     &TestHexAndBytes,
+    &TestAccumulator,             &TestStreamingAddition,
+    &TestBinaryFormat,            &TestFixedBigInt,
+    &TestMemoryResource,          &TestProductAndSumTree,
+    &TestRandomNumbersAddition,   &TestAdditionOperationTime,
 };
 
 // run all tests
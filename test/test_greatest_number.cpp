@@ -4,11 +4,14 @@
 #include <ctime>
 #include <iostream>
 #include <random>
+#include <stdexcept>
 #include <vector>
 
+#include "cpu_features.h"
 #include "greatest_number.h"
+#include "thread_pool.h"
 
-#define NUM_TESTS 5
+#define NUM_TESTS 10
 
 using namespace std::literals::string_literals;
 using std::cout;
@@ -111,6 +114,219 @@ void TestRandomNumbersAndLimit() {
   }
 }
 
+/**
+ * The greatest sum of at most 4 numbers not above the limit by trying all
+ * combinations.
+ */
+int GreatestByAllCombinations(const vector<int> &numbers, int limit) {
+  // 0 stands for a number that is not picked
+  vector<int> choices = numbers;
+  choices.push_back(0);
+  int greatest = 0;
+  for (int a : choices) {
+    for (int b : choices) {
+      for (int c : choices) {
+        for (int d : choices) {
+          if (a + b + c + d <= limit) {
+            greatest = std::max(greatest, a + b + c + d);
+          }
+        }
+      }
+    }
+  }
+  return greatest;
+}
+
+/**
+ * Compares with all combinations of at most 4 numbers on small random sets.
+ */
+void TestAgainstAllCombinations() {
+  cout << "TestAgainstAllCombinations"s << endl;
+
+  vector<int> numbers = {5, 40};
+  assert((FindGreatestNumber(numbers, 50) == 50));
+
+  std::mt19937 generator(21);
+  std::uniform_int_distribution<int> distribution_number(0, 1000);
+  // The last sets have enough two sums for the radix sort
+  for (int i = 0; i < 305; ++i) {
+    vector<int> numbers(i < 300 ? i % 12 : 60);
+    for (int &number : numbers) {
+      number = distribution_number(generator);
+    }
+    int limit = distribution_number(generator) * 3;
+    int expected = GreatestByAllCombinations(numbers, limit);
+    assert((FindGreatestNumber(numbers, limit) == expected));
+  }
+}
+
+/**
+ * Many small numbers and a small limit go to the bitset engine.
+ */
+void TestSmallLimit() {
+  cout << "TestSmallLimit"s << endl;
+
+  vector<int> numbers = {0, 0, 7, 7, 7, 64, 130};
+  assert((FindGreatestNumber(numbers, 207) == 201));
+  numbers = {63, 64, 65};
+  assert((FindGreatestNumber(numbers, 256) == 256));
+  numbers = {0};
+  assert((FindGreatestNumber(numbers, 0) == 0));
+
+  // A negative number would index the bitset out of bounds
+  bool thrown = false;
+  try {
+    numbers = {-5, 3};
+    FindGreatestNumber(numbers, 10);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert((thrown));
+
+  std::mt19937 generator(23);
+  std::uniform_int_distribution<int> distribution_number(0, 200);
+  for (int i = 0; i < 50; ++i) {
+    vector<int> numbers(40);
+    for (int &number : numbers) {
+      number = distribution_number(generator);
+    }
+    int limit = distribution_number(generator) * (i % 4 + 1);
+    int expected = GreatestByAllCombinations(numbers, limit);
+    assert((FindGreatestNumber(numbers, limit) == expected));
+  }
+
+  // 10^4 numbers of 500 distinct even values: 5 * 10^7 two sums against 4
+  // layers of 500 shifts of a 79 word bitset
+  vector<int> many(10000);
+  for (size_t i = 0; i < many.size(); ++i) {
+    many[i] = 2 * (i % 500) + 1000;
+  }
+  std::clock_t start = std::clock();
+  assert((FindGreatestNumber(many, 5001) == 5000));
+  std::clock_t end = std::clock();
+  std::cout << "10000 numbers, limit 5001: "
+            << 1000.0 * (end - start) / CLOCKS_PER_SEC << " ms (CPU time)"
+            << endl;
+}
+
+void TestGreatestNumberIndex() {
+  cout << "TestGreatestNumberIndex"s << endl;
+
+  GreatestNumberIndex empty({});
+  assert((empty.size() == 1));
+  assert((empty.find(10) == 0));
+
+  // Sums 0, 3, 6, 8, 11, 16 are stored once
+  GreatestNumberIndex index({8, 3, 3, 8});
+  assert((index.size() == 6));
+  assert((index.find(-1) == 0));
+  assert((index.find(2) == 0));
+  assert((index.find(10) == 9));
+  assert((index.find(100) == 32));
+  assert((index.find({100, -5, 10, 2, 10}) == vector<int>{32, 0, 9, 0, 9}));
+
+  bool thrown = false;
+  try {
+    GreatestNumberIndex negative({1, -1});
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert((thrown));
+
+  // Answers must be the same as FindGreatestNumber gives for every limit
+  std::mt19937 generator(24);
+  std::uniform_int_distribution<int> distribution_number(0, 1000000000);
+  for (int i = 0; i < 20; ++i) {
+    vector<int> numbers(i * 7 % 100);
+    for (int &number : numbers) {
+      number = distribution_number(generator) / (i % 3 == 0 ? 1000 : 1);
+    }
+    GreatestNumberIndex index(numbers);
+
+    vector<int> limits(50);
+    for (int &limit : limits) {
+      limit = distribution_number(generator) / (i % 2 ? 100 : 1);
+    }
+    limits[0] = limits[1];
+    vector<int> answers = index.find(limits);
+    for (size_t j = 0; j < limits.size(); ++j) {
+      vector<int> copy = numbers;
+      int expected = FindGreatestNumber(copy, limits[j]);
+      assert((index.find(limits[j]) == expected));
+      assert((answers[j] == expected));
+    }
+  }
+}
+
+void TestParallelSearch() {
+  cout << "TestParallelSearch"s << endl;
+
+  // Many blocks on a small pool, limits that are hit exactly and limits of
+  // another parity that are never hit
+  thread_pool_huawei::ThreadPool pool(4);
+  std::mt19937 generator(25);
+  std::uniform_int_distribution<int> distribution_number(0, 500000000);
+  for (int n : {0, 1, 10, 300, 700, 1500}) {
+    for (int parity = 0; parity < 2; ++parity) {
+      vector<int> numbers(n);
+      for (int &number : numbers) {
+        number = 2 * distribution_number(generator);
+      }
+      int limit = 2 * distribution_number(generator) + parity;
+
+      vector<int> copy = numbers;
+      int expected = FindGreatestNumber(copy, limit);
+      assert((FindGreatestNumberParallel(numbers, limit, pool) == expected));
+    }
+  }
+
+  vector<int> numbers = {1000000000, 1, 1000000000};
+  assert((FindGreatestNumberParallel(numbers, 1000000000, pool) ==
+          1000000000));
+
+  bool thrown = false;
+  try {
+    numbers = {-5, 3};
+    FindGreatestNumberParallel(numbers, 10, pool);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert((thrown));
+  numbers = {};
+  assert((FindGreatestNumberParallel(numbers, 100) == 0));
+}
+
+void TestSearchKernels() {
+  cout << "TestSearchKernels"s << endl;
+
+  // Every level must give the same results as the scalar one, odd sets
+  // have small numbers and go to the bitset engine
+  using cpu_huawei::SimdLevel;
+  SimdLevel initial = cpu_huawei::simd_level();
+  std::mt19937 generator(20);
+  std::uniform_int_distribution<int> distribution_number(0, 100000);
+  for (int i = 0; i < 200; ++i) {
+    int scale = i % 2 ? 100 : 1;
+    vector<int> numbers(i % 50);
+    for (int &number : numbers) {
+      number = distribution_number(generator) / scale;
+    }
+    int limit = distribution_number(generator) * 3 / scale;
+
+    cpu_huawei::set_simd_level(SimdLevel::scalar);
+    vector<int> sorted = numbers;
+    int expected = FindGreatestNumber(sorted, limit);
+    assert((expected <= limit));
+    int detected = static_cast<int>(cpu_huawei::detected_simd_level());
+    for (int level = 1; level <= detected; ++level) {
+      cpu_huawei::set_simd_level(static_cast<SimdLevel>(level));
+      sorted = numbers;
+      assert((FindGreatestNumber(sorted, limit) == expected));
+    }
+  }
+  cpu_huawei::set_simd_level(initial);
+}
+
 void TestGreatestNumberTime() {
   cout << "TestGreatestNumberTime"s << endl;
   cout << "There are 1000 numbers of all ones and the limit is 1000000000"
@@ -134,7 +350,9 @@ typedef void (*PROC)(void);
 const PROC tests[NUM_TESTS] = {
     &TestEmptyListOfNumbers,      &TestNumbersAllGreaterThanLimit,
     &TestNumbersWithNonZeroLimit, &TestNumbersWithMaxValues,
-    &TestGreatestNumberTime,
+    &TestAgainstAllCombinations,  &TestSmallLimit,
+    &TestGreatestNumberIndex,     &TestParallelSearch,
+    &TestSearchKernels,           &TestGreatestNumberTime,
 };
 
 // run all tests